@@ -139,6 +139,7 @@ bool Action_setUserOnly(const char* userName, uid_t* userId) {
 
 static void tagAllChildren(Panel* panel, Process* parent) {
    parent->tag = true;
+   parent->changed |= PROCESS_CHANGED_BASE;
    pid_t ppid = parent->pid;
    for (int i = 0; i < Panel_size(panel); i++) {
       Process* p = (Process*) Panel_get(panel, i);
@@ -152,6 +153,7 @@ static bool expandCollapse(Panel* panel) {
    Process* p = (Process*) Panel_getSelected(panel);
    if (!p) return false;
    p->showChildren = !p->showChildren;
+   p->changed |= PROCESS_CHANGED_BASE;
    return true;
 }
 
@@ -163,6 +165,7 @@ static bool collapseIntoParent(Panel* panel) {
       Process* q = (Process*) Panel_get(panel, i);
       if (q->pid == ppid) {
          q->showChildren = false;
+         q->changed |= PROCESS_CHANGED_BASE;
          Panel_setSelected(panel, i);
          return true;
       }
@@ -337,7 +340,7 @@ static Htop_Reaction actionFilterByUser(State* st) {
    Panel* usersPanel = Panel_new(0, 0, 0, 0, true, Class(ListItem), FunctionBar_newEnterEsc("Show   ", "Cancel "));
    Panel_setHeader(usersPanel, "Show processes of:");
    UsersTable_foreach(st->ut, addUserToVector, usersPanel);
-   Vector_insertionSort(usersPanel->items);
+   Vector_sort(usersPanel->items);
    ListItem* allUsers = ListItem_new("All users", -1);
    Panel_insert(usersPanel, 0, (Object*) allUsers);
    ListItem* picked = (ListItem*) Action_pickFromVector(st, usersPanel, 20);
@@ -522,6 +525,7 @@ static Htop_Reaction actionUntagAll(State* st) {
    for (int i = 0; i < Panel_size(st->panel); i++) {
       Process* p = (Process*) Panel_get(st->panel, i);
       p->tag = false;
+      p->changed |= PROCESS_CHANGED_BASE;
    }
    return HTOP_REFRESH;
 }
@@ -45,6 +45,7 @@ static void CheckItem_display(Object* cast, RichString* out) {
 }
 
 ObjectClass CheckItem_class = {
+   .extends = Class(Object),
    .display = CheckItem_display,
    .delete = CheckItem_delete
 };
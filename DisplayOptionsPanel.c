@@ -8,6 +8,7 @@ in the source distribution for its full text.
 #include "DisplayOptionsPanel.h"
 
 #include "CheckItem.h"
+#include "NumberItem.h"
 #include "CRT.h"
 
 #include <assert.h>
@@ -41,7 +42,8 @@ static HandlerResult DisplayOptionsPanel_eventHandler(Panel* super, int ch) {
    DisplayOptionsPanel* this = (DisplayOptionsPanel*) super;
    
    HandlerResult result = IGNORED;
-   CheckItem* selected = (CheckItem*) Panel_getSelected(super);
+   Object* selected = Panel_getSelected(super);
+   bool isNumber = (Object_getClass(selected) == Class(NumberItem));
 
    switch(ch) {
    case 0x0a:
@@ -50,8 +52,25 @@ static HandlerResult DisplayOptionsPanel_eventHandler(Panel* super, int ch) {
    case KEY_MOUSE:
    case KEY_RECLICK:
    case ' ':
-      CheckItem_set(selected, ! (CheckItem_get(selected)) );
+      if (isNumber)
+         NumberItem_increase((NumberItem*) selected, true);
+      else
+         CheckItem_set((CheckItem*) selected, ! (CheckItem_get((CheckItem*) selected)) );
       result = HANDLED;
+      break;
+   case '+':
+   case '=':
+      if (isNumber) {
+         NumberItem_increase((NumberItem*) selected, false);
+         result = HANDLED;
+      }
+      break;
+   case '-':
+      if (isNumber) {
+         NumberItem_decrease((NumberItem*) selected);
+         result = HANDLED;
+      }
+      break;
    }
 
    if (result == HANDLED) {
@@ -77,7 +96,7 @@ DisplayOptionsPanel* DisplayOptionsPanel_new(Settings* settings, ScreenManager*
    DisplayOptionsPanel* this = AllocThis(DisplayOptionsPanel);
    Panel* super = (Panel*) this;
    FunctionBar* fuBar = FunctionBar_new(DisplayOptionsFunctions, NULL, NULL);
-   Panel_init(super, 1, 1, 1, 1, Class(CheckItem), true, fuBar);
+   Panel_init(super, 1, 1, 1, 1, Class(Object), true, fuBar);
 
    this->settings = settings;
    this->scr = scr;
@@ -96,6 +115,11 @@ DisplayOptionsPanel* DisplayOptionsPanel_new(Settings* settings, ScreenManager*
    Panel_add(super, (Object*) CheckItem_newByRef(xStrdup("Detailed CPU time (System/IO-Wait/Hard-IRQ/Soft-IRQ/Steal/Guest)"), &(settings->detailedCPUTime)));
    Panel_add(super, (Object*) CheckItem_newByRef(xStrdup("Count CPUs from 0 instead of 1"), &(settings->countCPUsFromZero)));
    Panel_add(super, (Object*) CheckItem_newByRef(xStrdup("Update process names on every refresh"), &(settings->updateProcessNames)));
+   Panel_add(super, (Object*) CheckItem_newByRef(xStrdup("Reduce screen updates for slow terminals"), &(settings->lowBandwidth)));
    Panel_add(super, (Object*) CheckItem_newByRef(xStrdup("Add guest time in CPU meter percentage"), &(settings->accountGuestInCPUMeter)));
+   Panel_add(super, (Object*) NumberItem_newByRef(xStrdup("Update cgroup, OOM score and IO priority every N refreshes"), &(settings->slowRefreshPeriod), 1, MAX_SLOW_REFRESH_PERIOD, 1));
+   #ifdef HAVE_DELAYACCT
+   Panel_add(super, (Object*) NumberItem_newByRef(xStrdup("Time for delay accounting per refresh, in ms (0: no limit)"), &(settings->delayAcctBudget), 0, MAX_DELAYACCT_BUDGET, 10));
+   #endif
    return this;
 }
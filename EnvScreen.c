@@ -60,7 +60,7 @@ void EnvScreen_scan(InfoScreen* this) {
       InfoScreen_addLine(this, "Could not read process environment.");
    }
 
-   Vector_insertionSort(this->lines);
-   Vector_insertionSort(panel->items);
+   Vector_sort(this->lines);
+   Vector_sort(panel->items);
    Panel_setSelected(panel, idx);
 }
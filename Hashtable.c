@@ -9,6 +9,7 @@ in the source distribution for its full text.
 #include "XAlloc.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 /*{
@@ -20,40 +21,63 @@ typedef void(*Hashtable_PairFunction)(int, void*, void*);
 
 typedef struct HashtableItem {
    unsigned int key;
+   unsigned int probe;
    void* value;
-   struct HashtableItem* next;
 } HashtableItem;
 
 struct Hashtable_ {
    int size;
-   HashtableItem** buckets;
+   HashtableItem* buckets;
    int items;
    bool owner;
 };
 }*/
 
+/*
+ * Open addressing with Robin Hood linear probing: each item records how far
+ * it sits from its home bucket, inserts displace items that are closer to
+ * home, and removals shift the following run back by one slot, so no
+ * tombstones are ever left behind. A NULL value marks an empty bucket.
+ */
+
+/* grow once the table is more than 7/10 full */
+#define Hashtable_needsGrow(this_) ((this_)->items * 10 > (this_)->size * 7)
+
+static const int primes[] = {
+   // roughly doubling, so growing to the next entry keeps resizes amortized
+   7, 13, 31, 61, 127, 251, 509, 1021, 2039, 4093, 8191, 16381, 32749, 65521,
+   131071, 262139, 524287, 1048573, 2097143, 4194301, 8388593, 16777213,
+   33554393, 67108859, 134217689, 268435399, 536870909, 1073741789
+};
+
+static int nextPrime(int n) {
+   for (unsigned int i = 0; i < sizeof(primes) / sizeof(primes[0]); i++) {
+      if (primes[i] >= n)
+         return primes[i];
+   }
+   return primes[sizeof(primes) / sizeof(primes[0]) - 1];
+}
+
 #ifdef DEBUG
 
 static bool Hashtable_isConsistent(Hashtable* this) {
    int items = 0;
    for (int i = 0; i < this->size; i++) {
-      HashtableItem* bucket = this->buckets[i];
-      while (bucket) {
+      HashtableItem* bucket = &(this->buckets[i]);
+      if (bucket->value) {
          items++;
-         bucket = bucket->next;
+         if ((bucket->key % this->size + bucket->probe) % this->size != (unsigned int) i)
+            return false;
       }
    }
-   return items == this->items;
+   return items == this->items && items < this->size;
 }
 
 int Hashtable_count(Hashtable* this) {
    int items = 0;
    for (int i = 0; i < this->size; i++) {
-      HashtableItem* bucket = this->buckets[i];
-      while (bucket) {
+      if (this->buckets[i].value)
          items++;
-         bucket = bucket->next;
-      }
    }
    assert(items == this->items);
    return items;
@@ -61,23 +85,13 @@ int Hashtable_count(Hashtable* this) {
 
 #endif
 
-static HashtableItem* HashtableItem_new(unsigned int key, void* value) {
-   HashtableItem* this;
-   
-   this = xMalloc(sizeof(HashtableItem));
-   this->key = key;
-   this->value = value;
-   this->next = NULL;
-   return this;
-}
-
 Hashtable* Hashtable_new(int size, bool owner) {
    Hashtable* this;
-   
+
    this = xMalloc(sizeof(Hashtable));
    this->items = 0;
-   this->size = size;
-   this->buckets = (HashtableItem**) xCalloc(size, sizeof(HashtableItem*));
+   this->size = nextPrime(size);
+   this->buckets = (HashtableItem*) xCalloc(this->size, sizeof(HashtableItem));
    this->owner = owner;
    assert(Hashtable_isConsistent(this));
    return this;
@@ -85,88 +99,122 @@ Hashtable* Hashtable_new(int size, bool owner) {
 
 void Hashtable_delete(Hashtable* this) {
    assert(Hashtable_isConsistent(this));
-   for (int i = 0; i < this->size; i++) {
-      HashtableItem* walk = this->buckets[i];
-      while (walk != NULL) {
-         if (this->owner)
-            free(walk->value);
-         HashtableItem* savedWalk = walk;
-         walk = savedWalk->next;
-         free(savedWalk);
-      }
+   if (this->owner) {
+      for (int i = 0; i < this->size; i++)
+         free(this->buckets[i].value);
    }
    free(this->buckets);
    free(this);
 }
 
-void Hashtable_put(Hashtable* this, unsigned int key, void* value) {
-   unsigned int index = key % this->size;
-   HashtableItem** bucketPtr = &(this->buckets[index]);
-   while (true)
-      if (*bucketPtr == NULL) {
-         *bucketPtr = HashtableItem_new(key, value);
+static void Hashtable_insert(Hashtable* this, unsigned int key, void* value) {
+   HashtableItem carry = { .key = key, .probe = 0, .value = value };
+   int index = key % this->size;
+   while (true) {
+      HashtableItem* bucket = &(this->buckets[index]);
+      if (bucket->value == NULL) {
+         *bucket = carry;
          this->items++;
-         break;
-      } else if ((*bucketPtr)->key == key) {
+         return;
+      } else if (bucket->key == carry.key) {
          if (this->owner)
-            free((*bucketPtr)->value);
-         (*bucketPtr)->value = value;
-         break;
-      } else
-         bucketPtr = &((*bucketPtr)->next);
+            free(bucket->value);
+         bucket->value = carry.value;
+         return;
+      } else if (bucket->probe < carry.probe) {
+         /* the key cannot be further along: take the slot and keep moving the poorer item */
+         HashtableItem tmp = *bucket;
+         *bucket = carry;
+         carry = tmp;
+      }
+      carry.probe++;
+      index++;
+      if (index == this->size)
+         index = 0;
+   }
+}
+
+static void Hashtable_resize(Hashtable* this, int size) {
+   HashtableItem* oldBuckets = this->buckets;
+   int oldSize = this->size;
+
+   this->size = nextPrime(size);
+   this->buckets = (HashtableItem*) xCalloc(this->size, sizeof(HashtableItem));
+   this->items = 0;
+   for (int i = 0; i < oldSize; i++) {
+      if (oldBuckets[i].value)
+         Hashtable_insert(this, oldBuckets[i].key, oldBuckets[i].value);
+   }
+   free(oldBuckets);
+}
+
+void Hashtable_put(Hashtable* this, unsigned int key, void* value) {
+   assert(value);
+   if (Hashtable_needsGrow(this))
+      Hashtable_resize(this, this->size + 1);
+   Hashtable_insert(this, key, value);
    assert(Hashtable_isConsistent(this));
 }
 
+static int Hashtable_find(Hashtable* this, unsigned int key) {
+   int index = key % this->size;
+   unsigned int probe = 0;
+   while (true) {
+      HashtableItem* bucket = &(this->buckets[index]);
+      if (bucket->value == NULL || bucket->probe < probe)
+         return -1;
+      if (bucket->key == key)
+         return index;
+      probe++;
+      index++;
+      if (index == this->size)
+         index = 0;
+   }
+}
+
 void* Hashtable_remove(Hashtable* this, unsigned int key) {
-   unsigned int index = key % this->size;
-   
    assert(Hashtable_isConsistent(this));
 
-   HashtableItem** bucket; 
-   for (bucket = &(this->buckets[index]); *bucket; bucket = &((*bucket)->next) ) {
-      if ((*bucket)->key == key) {
-         void* value = (*bucket)->value;
-         HashtableItem* next = (*bucket)->next;
-         free(*bucket);
-         (*bucket) = next;
-         this->items--;
-         if (this->owner) {
-            free(value);
-            assert(Hashtable_isConsistent(this));
-            return NULL;
-         } else {
-            assert(Hashtable_isConsistent(this));
-            return value;
-         }
-      }
+   int index = Hashtable_find(this, key);
+   if (index == -1)
+      return NULL;
+
+   void* value = this->buckets[index].value;
+   /* backward shift deletion: pull the rest of the run one slot closer to home */
+   while (true) {
+      int next = index + 1;
+      if (next == this->size)
+         next = 0;
+      HashtableItem* nextBucket = &(this->buckets[next]);
+      if (nextBucket->value == NULL || nextBucket->probe == 0)
+         break;
+      this->buckets[index] = *nextBucket;
+      this->buckets[index].probe--;
+      index = next;
    }
+   memset(&(this->buckets[index]), 0, sizeof(HashtableItem));
+   this->items--;
+
    assert(Hashtable_isConsistent(this));
-   return NULL;
+   if (this->owner) {
+      free(value);
+      return NULL;
+   }
+   return value;
 }
 
 inline void* Hashtable_get(Hashtable* this, unsigned int key) {
-   unsigned int index = key % this->size;
-   HashtableItem* bucketPtr = this->buckets[index];
-   while (true) {
-      if (bucketPtr == NULL) {
-         assert(Hashtable_isConsistent(this));
-         return NULL;
-      } else if (bucketPtr->key == key) {
-         assert(Hashtable_isConsistent(this));
-         return bucketPtr->value;
-      } else
-         bucketPtr = bucketPtr->next;
-   }
+   int index = Hashtable_find(this, key);
+   assert(Hashtable_isConsistent(this));
+   return (index == -1) ? NULL : this->buckets[index].value;
 }
 
 void Hashtable_foreach(Hashtable* this, Hashtable_PairFunction f, void* userData) {
    assert(Hashtable_isConsistent(this));
    for (int i = 0; i < this->size; i++) {
-      HashtableItem* walk = this->buckets[i];
-      while (walk != NULL) {
+      HashtableItem* walk = &(this->buckets[i]);
+      if (walk->value)
          f(walk->key, walk->value, userData);
-         walk = walk->next;
-      }
    }
    assert(Hashtable_isConsistent(this));
 }
@@ -17,17 +17,27 @@ typedef void(*Hashtable_PairFunction)(int, void*, void*);
 
 typedef struct HashtableItem {
    unsigned int key;
+   unsigned int probe;
    void* value;
-   struct HashtableItem* next;
 } HashtableItem;
 
 struct Hashtable_ {
    int size;
-   HashtableItem** buckets;
+   HashtableItem* buckets;
    int items;
    bool owner;
 };
 
+/*
+ * Open addressing with Robin Hood linear probing: each item records how far
+ * it sits from its home bucket, inserts displace items that are closer to
+ * home, and removals shift the following run back by one slot, so no
+ * tombstones are ever left behind. A NULL value marks an empty bucket.
+ */
+
+/* grow once the table is more than 7/10 full */
+#define Hashtable_needsGrow(this_) ((this_)->items * 10 > (this_)->size * 7)
+
 #ifdef DEBUG
 
 int Hashtable_count(Hashtable* this);
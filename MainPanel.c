@@ -49,8 +49,16 @@ void MainPanel_updateTreeFunctions(MainPanel* this, bool mode) {
    }
 }
 
+static void MainPanel_finishSort(MainPanel* this) {
+   // searches go through all rows, so these must all be in order
+   ProcessList* pl = this->state->pl;
+   if (ProcessList_finishSort(pl))
+      ProcessList_rebuildPanel(pl);
+}
+
 void MainPanel_pidSearch(MainPanel* this, int ch) {
    Panel* super = (Panel*) this;
+   MainPanel_finishSort(this);
    pid_t pid = ch-48 + this->pidSearch;
    for (int i = 0; i < Panel_size(super); i++) {
       Process* p = (Process*) Panel_get(super, i);
@@ -87,6 +95,8 @@ static HandlerResult MainPanel_eventHandler(Panel* super, int ch) {
       reaction |= HTOP_RECALCULATE | HTOP_REDRAW_BAR | HTOP_SAVE_SETTINGS; 
       result = HANDLED;
    } else if (ch != ERR && this->inc->active) {
+      if (this->inc->active == &(this->inc->modes[INC_SEARCH]))
+         MainPanel_finishSort(this);
       bool filterChanged = IncSet_handleKey(this->inc, ch, super, (IncMode_GetPanelValue) MainPanel_getValue, NULL);
       if (filterChanged) {
          this->state->pl->incFilter = IncSet_filter(this->inc);
@@ -173,12 +183,23 @@ bool MainPanel_foreachProcess(MainPanel* this, MainPanel_ForeachProcessFn fn, Ar
    return ok;
 }
 
+static bool MainPanel_itemChanged(Panel* super, Object* item) {
+   MainPanel* this = (MainPanel*) super;
+   Process* p = (Process*) item;
+   if (!this->state->pl->tracksChanges)
+      return true;
+   bool changed = p->changed & (this->state->settings->flags | PROCESS_CHANGED_BASE);
+   p->changed = 0;
+   return changed;
+}
+
 PanelClass MainPanel_class = {
    .super = {
       .extends = Class(Panel),
       .delete = MainPanel_delete
    },
-   .eventHandler = MainPanel_eventHandler
+   .eventHandler = MainPanel_eventHandler,
+   .itemChanged = MainPanel_itemChanged
 };
 
 MainPanel* MainPanel_new() {
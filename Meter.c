@@ -168,8 +168,16 @@ int Meter_humanUnit(char* buffer, unsigned long int value, int size) {
          break;
    }
 
-   written = snprintf(buffer, size, "%.*f%c",
-      precision, (double) value / powi, *prefix);
+   // powi is a power of two: while value * 100 fits in a double's
+   // mantissa the division is exact, and lrint rounds as printf does
+   if (size < 16 || value >= (1ULL << 53) / 100) {
+      return snprintf(buffer, size, "%.*f%c",
+         precision, (double) value / powi, *prefix);
+   }
+   unsigned long long scaled = (unsigned long long) value * (precision == 2 ? 100 : precision == 1 ? 10 : 1);
+   written = String_formatFixed(buffer, lrint((double) scaled / powi), precision, 0);
+   buffer[written++] = *prefix;
+   buffer[written] = '\0';
 
    return written;
 }
@@ -0,0 +1,76 @@
+/*
+htop - NumberItem.c
+(C) 2004-2011 Hisham H. Muhammad
+Released under the GNU GPL, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "NumberItem.h"
+
+#include "CRT.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+/*{
+#include "Object.h"
+
+typedef struct NumberItem_ {
+   Object super;
+   char* text;
+   int* ref;
+   int min;
+   int max;
+   int step;
+} NumberItem;
+
+}*/
+
+static void NumberItem_delete(Object* cast) {
+   NumberItem* this = (NumberItem*)cast;
+   assert (this != NULL);
+
+   free(this->text);
+   free(this);
+}
+
+static void NumberItem_display(Object* cast, RichString* out) {
+   NumberItem* this = (NumberItem*)cast;
+   assert (this != NULL);
+   char buffer[16];
+   xSnprintf(buffer, sizeof(buffer), "%3d", *(this->ref));
+   RichString_write(out, CRT_colors[CHECK_BOX], "[");
+   RichString_append(out, CRT_colors[CHECK_MARK], buffer);
+   RichString_append(out, CRT_colors[CHECK_BOX], "] ");
+   RichString_append(out, CRT_colors[CHECK_TEXT], this->text);
+}
+
+ObjectClass NumberItem_class = {
+   .extends = Class(Object),
+   .display = NumberItem_display,
+   .delete = NumberItem_delete
+};
+
+NumberItem* NumberItem_newByRef(char* text, int* ref, int min, int max, int step) {
+   NumberItem* this = AllocThis(NumberItem);
+   this->text = text;
+   this->ref = ref;
+   this->min = min;
+   this->max = max;
+   this->step = step;
+   return this;
+}
+
+void NumberItem_increase(NumberItem* this, bool wrap) {
+   int value = *(this->ref) + this->step;
+   if (value > this->max)
+      value = wrap ? this->min : this->max;
+   *(this->ref) = value;
+}
+
+void NumberItem_decrease(NumberItem* this) {
+   int value = *(this->ref) - this->step;
+   if (value < this->min)
+      value = this->min;
+   *(this->ref) = value;
+}
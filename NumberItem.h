@@ -0,0 +1,32 @@
+/* Do not edit this file. It was automatically generated. */
+
+#ifndef HEADER_NumberItem
+#define HEADER_NumberItem
+/*
+htop - NumberItem.h
+(C) 2004-2011 Hisham H. Muhammad
+Released under the GNU GPL, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "Object.h"
+
+typedef struct NumberItem_ {
+   Object super;
+   char* text;
+   int* ref;
+   int min;
+   int max;
+   int step;
+} NumberItem;
+
+
+extern ObjectClass NumberItem_class;
+
+NumberItem* NumberItem_newByRef(char* text, int* ref, int min, int max, int step);
+
+void NumberItem_increase(NumberItem* this, bool wrap);
+
+void NumberItem_decrease(NumberItem* this);
+
+#endif
@@ -174,7 +174,7 @@ void OpenFilesScreen_scan(InfoScreen* this) {
       OpenFiles_Data_clear(&pdata->data);
    }
    free(pdata);
-   Vector_insertionSort(this->lines);
-   Vector_insertionSort(panel->items);
+   Vector_sort(this->lines);
+   Vector_sort(panel->items);
    Panel_setSelected(panel, idx);
 }
@@ -44,15 +44,28 @@ typedef enum HandlerResult_ {
 #define EVENT_HEADER_CLICK_GET_X(ev_) (ev_ + 10000)
 
 typedef HandlerResult(*Panel_EventHandler)(Panel*, int);
+typedef bool(*Panel_ItemChanged)(Panel*, Object*);
 
 typedef struct PanelClass_ {
    const ObjectClass super;
    const Panel_EventHandler eventHandler;
+   // tells if an item may display differently since it was last asked;
+   // panels that have it keep their rows rendered between redraws
+   const Panel_ItemChanged itemChanged;
 } PanelClass;
 
 #define As_Panel(this_)                ((PanelClass*)((this_)->super.klass))
 #define Panel_eventHandlerFn(this_)    As_Panel(this_)->eventHandler
 #define Panel_eventHandler(this_, ev_) As_Panel(this_)->eventHandler((Panel*)(this_), ev_)
+#define Panel_itemChangedFn(this_)     As_Panel(this_)->itemChanged
+
+typedef struct PanelRow_ {
+   Object* item;
+   // named as in RichString, so that its print macros apply
+   int chlen;
+   CharType* chptr;
+   int size;
+} PanelRow;
 
 struct Panel_ {
    Object super;
@@ -70,6 +83,11 @@ struct Panel_ {
    FunctionBar* defaultBar;
    RichString header;
    int selectionColor;
+   // what each line shows, unselected, for panels with itemChanged
+   PanelRow* rows;
+   int rowCount;
+   // index of the item rows start at
+   int rowsFirst;
 };
 
 #define Panel_setDefaultBar(this_) do{ (this_)->currentBar = (this_)->defaultBar; }while(0)
@@ -123,6 +141,9 @@ void Panel_init(Panel* this, int x, int y, int w, int h, ObjectClass* type, bool
    this->defaultBar = fuBar;
    this->currentBar = fuBar;
    this->selectionColor = CRT_colors[PANEL_SELECTION_FOCUS];
+   this->rows = NULL;
+   this->rowCount = 0;
+   this->rowsFirst = 0;
 }
 
 void Panel_done(Panel* this) {
@@ -131,6 +152,9 @@ void Panel_done(Panel* this) {
    Vector_delete(this->items);
    FunctionBar_delete(this->defaultBar);
    RichString_end(this->header);
+   for (int i = 0; i < this->rowCount; i++)
+      free(this->rows[i].chptr);
+   free(this->rows);
 }
 
 void Panel_setSelectionColor(Panel* this, int color) {
@@ -264,6 +288,31 @@ void Panel_setSelected(Panel* this, int selected) {
    }
 }
 
+static void Panel_keepRow(PanelRow* row, Object* item, RichString* text) {
+   int len = RichString_size(text);
+   if (row->size < len + 1) {
+      row->size = len + 1;
+      row->chptr = xRealloc(row->chptr, sizeof(CharType) * row->size);
+   }
+   memcpy(row->chptr, text->chptr, sizeof(CharType) * (len + 1));
+   row->chlen = len;
+   row->item = item;
+}
+
+static void Panel_shiftRows(Panel* this, int shift, int n) {
+   // moves the first n rows up by shift lines, or down if negative,
+   // as the items they show
+   PanelRow shifted[n];
+   for (int i = 0; i < n; i++)
+      shifted[i] = this->rows[((i + shift) % n + n) % n];
+   memcpy(this->rows, shifted, sizeof(PanelRow) * n);
+   // the ones that wrapped around keep only their buffers
+   int from = shift > 0 ? n - shift : 0;
+   int to = shift > 0 ? n : -shift;
+   for (int i = from; i < to; i++)
+      this->rows[i].item = NULL;
+}
+
 void Panel_draw(Panel* this, bool focus) {
    assert (this != NULL);
 
@@ -313,15 +362,48 @@ void Panel_draw(Panel* this, bool focus) {
                  : CRT_colors[PANEL_SELECTION_UNFOCUS];
 
    if (this->needsRedraw) {
+      Panel_ItemChanged itemChanged = Panel_itemChangedFn(this);
+      if (itemChanged) {
+         if (this->rowCount < h) {
+            this->rows = xRealloc(this->rows, sizeof(PanelRow) * h);
+            memset(this->rows + this->rowCount, 0, sizeof(PanelRow) * (h - this->rowCount));
+            this->rowCount = h;
+         }
+         // rows below a shrunk panel are not drawn, so they must not be
+         // taken back as drawn when it grows again
+         for (int i = MAX(h, 0); i < this->rowCount; i++)
+            this->rows[i].item = NULL;
+         // after a scroll, the rows still on screen are not rendered again;
+         // ncurses turns their moving into a scroll of the terminal
+         int shift = first - this->rowsFirst;
+         if (shift != 0 && abs(shift) < h)
+            Panel_shiftRows(this, shift, h);
+         this->rowsFirst = first;
+      }
       int line = 0;
       for(int i = first; line < h && i < upTo; i++) {
          Object* itemObj = Vector_get(this->items, i);
          assert(itemObj); if(!itemObj) continue;
+         bool selected = (i == this->selected);
+         PanelRow* row = NULL;
+         if (itemChanged) {
+            row = &(this->rows[line]);
+            // rows that show the same as before are printed as they were
+            if (!itemChanged(this, itemObj) && row->item == itemObj && !selected) {
+               mvhline(y + line, x, ' ', this->w);
+               int amt = MIN(row->chlen - scrollH, this->w);
+               if (amt > 0)
+                  RichString_printoffnVal(*row, y + line, x, scrollH, amt);
+               line++;
+               continue;
+            }
+         }
          RichString_begin(item);
          Object_display(itemObj, &item);
+         if (row)
+            Panel_keepRow(row, itemObj, &item);
          int itemLen = RichString_sizeVal(item);
          int amt = MIN(itemLen - scrollH, this->w);
-         bool selected = (i == this->selected);
          if (selected) {
             attrset(selectionColor);
             RichString_setAttr(&item, selectionColor);
@@ -336,6 +418,8 @@ void Panel_draw(Panel* this, bool focus) {
          line++;
       }
       while (line < h) {
+         if (itemChanged)
+            this->rows[line].item = NULL;
          mvhline(y + line, x, ' ', this->w);
          line++;
       }
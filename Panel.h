@@ -33,15 +33,28 @@ typedef enum HandlerResult_ {
 #define EVENT_HEADER_CLICK_GET_X(ev_) (ev_ + 10000)
 
 typedef HandlerResult(*Panel_EventHandler)(Panel*, int);
+typedef bool(*Panel_ItemChanged)(Panel*, Object*);
 
 typedef struct PanelClass_ {
    const ObjectClass super;
    const Panel_EventHandler eventHandler;
+   // tells if an item may display differently since it was last asked;
+   // panels that have it keep their rows rendered between redraws
+   const Panel_ItemChanged itemChanged;
 } PanelClass;
 
 #define As_Panel(this_)                ((PanelClass*)((this_)->super.klass))
 #define Panel_eventHandlerFn(this_)    As_Panel(this_)->eventHandler
 #define Panel_eventHandler(this_, ev_) As_Panel(this_)->eventHandler((Panel*)(this_), ev_)
+#define Panel_itemChangedFn(this_)     As_Panel(this_)->itemChanged
+
+typedef struct PanelRow_ {
+   Object* item;
+   // named as in RichString, so that its print macros apply
+   int chlen;
+   CharType* chptr;
+   int size;
+} PanelRow;
 
 struct Panel_ {
    Object super;
@@ -59,6 +72,11 @@ struct Panel_ {
    FunctionBar* defaultBar;
    RichString header;
    int selectionColor;
+   // what each line shows, unselected, for panels with itemChanged
+   PanelRow* rows;
+   int rowCount;
+   // index of the item rows start at
+   int rowsFirst;
 };
 
 #define Panel_setDefaultBar(this_) do{ (this_)->currentBar = (this_)->defaultBar; }while(0)
@@ -24,6 +24,7 @@ in the source distribution for its full text.
 #include <signal.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <pwd.h>
 #include <time.h>
 #include <assert.h>
@@ -54,6 +55,11 @@ in the source distribution for its full text.
 
 #define PROCESS_FLAG_IO 0x0001
 
+// Process.changed bit for the values of the columns without PROCESS_FLAG_*
+#define PROCESS_CHANGED_BASE 0x40000000
+
+#define PROCESS_HOT_BYTES 64
+
 typedef enum ProcessFields {
    NULL_PROCESSFIELD = 0,
    PID = 1,
@@ -89,46 +95,50 @@ typedef struct ProcessPidColumn_ {
 typedef struct Process_ {
    Object super;
 
-   struct Settings_* settings;
-
+   // Hot block: the fields read by every scan and sort pass share the
+   // first cache line with the class pointer. Process_init checks that
+   // everything before settings fits in PROCESS_HOT_BYTES.
    unsigned long long int time;
    pid_t pid;
    pid_t ppid;
    pid_t tgid;
-   char* comm;
-   int commLen;
    int indent;
-
-   int basenameOffset;
-   bool updated;
-
+   float percent_cpu;
+   float percent_mem;
+   long m_resident;
    char state;
+   bool updated;
+   bool show;
    bool tag;
    bool showChildren;
-   bool show;
-   unsigned int pgrp;
-   unsigned int session;
-   unsigned int tty_nr;
-   int tpgid;
+   // on screen or near it, as of the last ProcessList_rebuildPanel
+   bool inView;
    uid_t st_uid;
-   unsigned long int flags;
-   int processor;
+   // PROCESS_FLAG_* groups of shown values changed since MainPanel last drew
+   // the row, with PROCESS_CHANGED_BASE for the rest of them
+   int changed;
 
-   float percent_cpu;
-   float percent_mem;
+   struct Settings_* settings;
+
+   char* comm;
+   int commLen;
+   int basenameOffset;
    char* user;
 
+   long m_size;
    long int priority;
    long int nice;
    long int nlwp;
+   int processor;
+   unsigned int pgrp;
+   unsigned int session;
+   unsigned int tty_nr;
+   int tpgid;
+   int exit_signal;
+   unsigned long int flags;
    char starttime_show[8];
    time_t starttime_ctime;
 
-   long m_size;
-   long m_resident;
-
-   int exit_signal;
-
    unsigned long int minflt;
    unsigned long int majflt;
    #ifdef DEBUG
@@ -157,6 +167,8 @@ typedef struct ProcessFieldData_ {
    const char* title;
    const char* description;
    int flags;
+   // comparators for direction 1 and its reverse, if the field has them
+   const Object_Compare* compare;
 } ProcessFieldData;
 
 // Implemented in platform-specific code:
@@ -170,10 +182,12 @@ extern char Process_pidFormat[20];
 
 typedef Process*(*Process_New)(struct Settings_*);
 typedef void (*Process_WriteField)(Process*, RichString*, ProcessField);
+typedef bool (*Process_SortKey)(const Process*, ProcessField, unsigned long long*);
 
 typedef struct ProcessClass_ {
    const ObjectClass super;
    const Process_WriteField writeField;
+   const Process_SortKey sortKey;
 } ProcessClass;
 
 #define As_Process(this_)              ((ProcessClass*)((this_)->super.klass))
@@ -184,6 +198,29 @@ typedef struct ProcessClass_ {
 
 #define Process_sortState(state) ((state) == 'I' ? 0x100 : (state))
 
+// Sort keys are unsigned and ascending: descending fields are inverted.
+#define Process_signedKey(v_)     ((unsigned long long)(long long)(v_) ^ 0x8000000000000000ULL)
+#define Process_unsignedKey(v_)   ((unsigned long long)(v_))
+#define Process_descendingKey(k_) (~(k_))
+
+#define Process_compareNumbers(a_, b_) (((a_) > (b_)) - ((a_) < (b_)))
+
+// Use as "static Process_comparator(name, type) { body }", where the body
+// compares p1 and p2: defines the comparator and its mirror, nameReversed.
+#define Process_comparator(name_, type_) \
+   long name_##Typed(const type_* p1, const type_* p2); \
+   static long name_(const void* v1, const void* v2) { \
+      return name_##Typed((const type_*) v1, (const type_*) v2); \
+   } \
+   static long name_##Reversed(const void* v1, const void* v2) { \
+      return name_##Typed((const type_*) v2, (const type_*) v1); \
+   } \
+   static inline long name_##Typed(const type_* p1, const type_* p2)
+
+#define Process_comparators(name_) { name_, name_##Reversed }
+
+#define PROCESS_MAX_SORT_CHAIN 4
+
 }*/
 
 static int Process_getuid = -1;
@@ -198,6 +235,8 @@ static int Process_getuid = -1;
 
 char Process_pidFormat[20] = "%7d ";
 
+int Process_pidDigits = 7;
+
 static char Process_titleBuffer[20][20];
 
 void Process_setupColumnWidths() {
@@ -211,10 +250,30 @@ void Process_setupColumnWidths() {
       Process_fields[Process_pidColumns[i].id].title = Process_titleBuffer[i];
    }
    xSnprintf(Process_pidFormat, sizeof(Process_pidFormat), "%%%dd ", digits);
+   Process_pidDigits = digits;
+}
+
+/* writes pid as Process_pidFormat does, returning the length */
+int Process_formatPid(char* buffer, int pid) {
+   int len = String_formatSigned(buffer, pid, Process_pidDigits);
+   buffer[len++] = ' ';
+   buffer[len] = '\0';
+   return len;
+}
+
+static inline int Process_formatSpaced(char* buffer, int len) {
+   buffer[len++] = ' ';
+   buffer[len] = '\0';
+   return len;
+}
+
+static inline void Process_formatTwoDigits(char* buffer, int value) {
+   buffer[0] = '0' + value / 10;
+   buffer[1] = '0' + value % 10;
 }
 
 void Process_humanNumber(RichString* str, unsigned long number, bool coloring) {
-   char buffer[11];
+   char buffer[24];
    int len;
    
    int largeNumberColor = CRT_colors[LARGE_NUMBER];
@@ -225,44 +284,58 @@ void Process_humanNumber(RichString* str, unsigned long number, bool coloring) {
       processMegabytesColor = CRT_colors[PROCESS];
    }
  
+   // the unit sizes are powers of two, so the tenths are rounded exactly
    if(number >= (10 * ONE_DECIMAL_M)) {
       #ifdef __LP64__
       if(number >= (100 * ONE_DECIMAL_G)) {
-         len = snprintf(buffer, 10, "%4luT ", number / ONE_G);
+         len = String_formatUnsigned(buffer, number / ONE_G, 4);
+         buffer[len++] = 'T';
+         len = Process_formatSpaced(buffer, len);
          RichString_appendn(str, largeNumberColor, buffer, len);
          return;
       } else if (number >= (1000 * ONE_DECIMAL_M)) {
-         len = snprintf(buffer, 10, "%4.1lfT ", (double)number / ONE_G);
+         len = String_formatFixed(buffer, lrint((double)number * 10 / ONE_G), 1, 4);
+         buffer[len++] = 'T';
+         len = Process_formatSpaced(buffer, len);
          RichString_appendn(str, largeNumberColor, buffer, len);
          return;
       }
       #endif
       if(number >= (100 * ONE_DECIMAL_M)) {
-         len = snprintf(buffer, 10, "%4luG ", number / ONE_M);
+         len = String_formatUnsigned(buffer, number / ONE_M, 4);
+         buffer[len++] = 'G';
+         len = Process_formatSpaced(buffer, len);
          RichString_appendn(str, largeNumberColor, buffer, len);
          return;
       }
-      len = snprintf(buffer, 10, "%4.1lfG ", (double)number / ONE_M);
+      len = String_formatFixed(buffer, lrint((double)number * 10 / ONE_M), 1, 4);
+      buffer[len++] = 'G';
+      len = Process_formatSpaced(buffer, len);
       RichString_appendn(str, largeNumberColor, buffer, len);
       return;
    } else if (number >= 100000) {
-      len = snprintf(buffer, 10, "%4luM ", number / ONE_K);
+      len = String_formatUnsigned(buffer, number / ONE_K, 4);
+      buffer[len++] = 'M';
+      len = Process_formatSpaced(buffer, len);
       RichString_appendn(str, processMegabytesColor, buffer, len);
       return;
    } else if (number >= 1000) {
-      len = snprintf(buffer, 10, "%2lu", number/1000);
+      len = String_formatUnsigned(buffer, number / 1000, 2);
       RichString_appendn(str, processMegabytesColor, buffer, len);
       number %= 1000;
-      len = snprintf(buffer, 10, "%03lu ", number);
+      buffer[0] = '0' + number / 100;
+      Process_formatTwoDigits(buffer + 1, number % 100);
+      len = Process_formatSpaced(buffer, 3);
       RichString_appendn(str, processColor, buffer, len);
       return;
    }
-   len = snprintf(buffer, 10, "%5lu ", number);
+   len = String_formatUnsigned(buffer, number, 5);
+   len = Process_formatSpaced(buffer, len);
    RichString_appendn(str, processColor, buffer, len);
 }
 
 void Process_colorNumber(RichString* str, unsigned long long number, bool coloring) {
-   char buffer[14];
+   char buffer[24];
 
    int largeNumberColor = CRT_colors[LARGE_NUMBER];
    int processMegabytesColor = CRT_colors[PROCESS_MEGABYTES];
@@ -275,15 +348,14 @@ void Process_colorNumber(RichString* str, unsigned long long number, bool colori
    }
 
    if ((long long) number == -1LL) {
-      int len = snprintf(buffer, 13, "    no perm ");
-      RichString_appendn(str, CRT_colors[PROCESS_SHADOW], buffer, len);
+      RichString_append(str, CRT_colors[PROCESS_SHADOW], "    no perm ");
    } else if (number > 10000000000) {
-      xSnprintf(buffer, 13, "%11llu ", number / 1000);
+      Process_formatSpaced(buffer, String_formatUnsigned(buffer, number / 1000, 11));
       RichString_appendn(str, largeNumberColor, buffer, 5);
       RichString_appendn(str, processMegabytesColor, buffer+5, 3);
       RichString_appendn(str, processColor, buffer+8, 4);
    } else {
-      xSnprintf(buffer, 13, "%11llu ", number);
+      Process_formatSpaced(buffer, String_formatUnsigned(buffer, number, 11));
       RichString_appendn(str, largeNumberColor, buffer, 2);
       RichString_appendn(str, processMegabytesColor, buffer+2, 3);
       RichString_appendn(str, processColor, buffer+5, 3);
@@ -298,19 +370,31 @@ void Process_printTime(RichString* str, unsigned long long totalHundredths) {
    int minutes = (totalSeconds / 60) % 60;
    int seconds = totalSeconds % 60;
    int hundredths = totalHundredths - (totalSeconds * 100);
-   char buffer[11];
+   char buffer[24];
+   int len;
    if (hours >= 100) {
-      xSnprintf(buffer, 10, "%7lluh ", hours);
-      RichString_append(str, CRT_colors[LARGE_NUMBER], buffer);
+      len = String_formatUnsigned(buffer, hours, 7);
+      buffer[len++] = 'h';
+      len = Process_formatSpaced(buffer, len);
+      RichString_appendn(str, CRT_colors[LARGE_NUMBER], buffer, len);
    } else {
       if (hours) {
-         xSnprintf(buffer, 10, "%2lluh", hours);
-         RichString_append(str, CRT_colors[LARGE_NUMBER], buffer);
-         xSnprintf(buffer, 10, "%02d:%02d ", minutes, seconds);
+         len = String_formatUnsigned(buffer, hours, 2);
+         buffer[len++] = 'h';
+         RichString_appendn(str, CRT_colors[LARGE_NUMBER], buffer, len);
+         Process_formatTwoDigits(buffer, minutes);
+         buffer[2] = ':';
+         Process_formatTwoDigits(buffer + 3, seconds);
+         len = Process_formatSpaced(buffer, 5);
       } else {
-         xSnprintf(buffer, 10, "%2d:%02d.%02d ", minutes, seconds, hundredths);
+         len = String_formatUnsigned(buffer, minutes, 2);
+         buffer[len++] = ':';
+         Process_formatTwoDigits(buffer + len, seconds);
+         buffer[len + 2] = '.';
+         Process_formatTwoDigits(buffer + len + 3, hundredths);
+         len = Process_formatSpaced(buffer, len + 5);
       }
-      RichString_append(str, CRT_colors[DEFAULT_COLOR], buffer);
+      RichString_appendn(str, CRT_colors[DEFAULT_COLOR], buffer, len);
    }
 }
 
@@ -380,9 +464,13 @@ void Process_writeField(Process* this, RichString* str, ProcessField field) {
    switch (field) {
    case PERCENT_CPU: {
       if (this->percent_cpu > 999.9) {
-         xSnprintf(buffer, n, "%4u ", (unsigned int)this->percent_cpu); 
+         Process_formatSpaced(buffer, String_formatUnsigned(buffer, (unsigned int)this->percent_cpu, 4));
       } else if (this->percent_cpu > 99.9) {
-         xSnprintf(buffer, n, "%3u. ", (unsigned int)this->percent_cpu); 
+         int len = String_formatUnsigned(buffer, (unsigned int)this->percent_cpu, 3);
+         buffer[len++] = '.';
+         Process_formatSpaced(buffer, len);
+      } else if (this->percent_cpu >= 0) {
+         Process_formatSpaced(buffer, String_formatFixed(buffer, lrint(this->percent_cpu * 10.0), 1, 4));
       } else {
          xSnprintf(buffer, n, "%4.1f ", this->percent_cpu);
       }
@@ -391,6 +479,8 @@ void Process_writeField(Process* this, RichString* str, ProcessField field) {
    case PERCENT_MEM: {
       if (this->percent_mem > 99.9) {
          xSnprintf(buffer, n, "100. "); 
+      } else if (this->percent_mem >= 0) {
+         Process_formatSpaced(buffer, String_formatFixed(buffer, lrint(this->percent_mem * 10.0), 1, 4));
       } else {
          xSnprintf(buffer, n, "%4.1f ", this->percent_mem);
       }
@@ -439,28 +529,29 @@ void Process_writeField(Process* this, RichString* str, ProcessField field) {
    case M_RESIDENT: Process_humanNumber(str, this->m_resident * PAGE_SIZE_KB, coloring); return;
    case M_SIZE: Process_humanNumber(str, this->m_size * PAGE_SIZE_KB, coloring); return;
    case NICE: {
-      xSnprintf(buffer, n, "%3ld ", this->nice);
+      Process_formatSpaced(buffer, String_formatSigned(buffer, this->nice, 3));
       attr = this->nice < 0 ? CRT_colors[PROCESS_HIGH_PRIORITY]
            : this->nice > 0 ? CRT_colors[PROCESS_LOW_PRIORITY]
            : attr;
       break;
    }
-   case NLWP: xSnprintf(buffer, n, "%4ld ", this->nlwp); break;
-   case PGRP: xSnprintf(buffer, n, Process_pidFormat, this->pgrp); break;
-   case PID: xSnprintf(buffer, n, Process_pidFormat, this->pid); break;
-   case PPID: xSnprintf(buffer, n, Process_pidFormat, this->ppid); break;
+   case NLWP: Process_formatSpaced(buffer, String_formatSigned(buffer, this->nlwp, 4)); break;
+   case PGRP: Process_formatPid(buffer, this->pgrp); break;
+   case PID: Process_formatPid(buffer, this->pid); break;
+   case PPID: Process_formatPid(buffer, this->ppid); break;
    case PRIORITY: {
       if(this->priority <= -100)
          xSnprintf(buffer, n, " RT ");
       else
-         xSnprintf(buffer, n, "%3ld ", this->priority);
+         Process_formatSpaced(buffer, String_formatSigned(buffer, this->priority, 3));
       break;
    }
-   case PROCESSOR: xSnprintf(buffer, n, "%3d ", Settings_cpuId(this->settings, this->processor)); break;
-   case SESSION: xSnprintf(buffer, n, Process_pidFormat, this->session); break;
+   case PROCESSOR: Process_formatSpaced(buffer, String_formatSigned(buffer, Settings_cpuId(this->settings, this->processor), 3)); break;
+   case SESSION: Process_formatPid(buffer, this->session); break;
    case STARTTIME: xSnprintf(buffer, n, "%s", this->starttime_show); break;
    case STATE: {
-      xSnprintf(buffer, n, "%c ", this->state);
+      buffer[0] = this->state;
+      Process_formatSpaced(buffer, 1);
       switch(this->state) {
           case 'R':
               attr = CRT_colors[PROCESS_R_STATE];
@@ -471,10 +562,10 @@ void Process_writeField(Process* this, RichString* str, ProcessField field) {
       }
       break;
    }
-   case ST_UID: xSnprintf(buffer, n, "%4d ", this->st_uid); break;
+   case ST_UID: Process_formatSpaced(buffer, String_formatSigned(buffer, (int) this->st_uid, 4)); break;
    case TIME: Process_printTime(str, this->time); return;
-   case TGID: xSnprintf(buffer, n, Process_pidFormat, this->tgid); break;
-   case TPGID: xSnprintf(buffer, n, Process_pidFormat, this->tpgid); break;
+   case TGID: Process_formatPid(buffer, this->tgid); break;
+   case TPGID: Process_formatPid(buffer, this->tpgid); break;
    case TTY_NR: xSnprintf(buffer, n, "%3u:%3u ", major(this->tty_nr), minor(this->tty_nr)); break;
    case USER: {
       if (Process_getuid != (int) this->st_uid)
@@ -525,17 +616,20 @@ ProcessClass Process_class = {
 };
 
 void Process_init(Process* this, struct Settings_* settings) {
+   assert(offsetof(Process, settings) <= PROCESS_HOT_BYTES);
    this->settings = settings;
    this->tag = false;
    this->showChildren = true;
    this->show = true;
    this->updated = false;
    this->basenameOffset = -1;
+   this->changed = ~0;
    if (Process_getuid == -1) Process_getuid = getuid();
 }
 
 void Process_toggleTag(Process* this) {
    this->tag = this->tag == true ? false : true;
+   this->changed |= PROCESS_CHANGED_BASE;
 }
 
 bool Process_setPriority(Process* this, int priority) {
@@ -565,68 +659,225 @@ long Process_pidCompare(const void* v1, const void* v2) {
    return (p1->pid - p2->pid);
 }
 
-long Process_compare(const void* v1, const void* v2) {
-   Process *p1, *p2;
-   Settings *settings = ((Process*)v1)->settings;
-   if (settings->direction == 1) {
-      p1 = (Process*)v1;
-      p2 = (Process*)v2;
-   } else {
-      p2 = (Process*)v1;
-      p1 = (Process*)v2;
-   }
-   switch (settings->sortKey) {
+unsigned long long Process_floatKey(double value) {
+   union { double d; unsigned long long u; } bits = { .d = value };
+   // negative numbers order by magnitude backwards, and below positives
+   return (bits.u >> 63) ? ~bits.u : (bits.u | 0x8000000000000000ULL);
+}
+
+/*
+ * Gives a key that orders processes by the field the way Process_compare
+ * does with direction 1, or false for fields compared as strings.
+ */
+bool Process_sortKey(const Process* this, ProcessField field, unsigned long long* key) {
+   switch (field) {
    case PERCENT_CPU:
-      return (p2->percent_cpu > p1->percent_cpu ? 1 : -1);
+      *key = Process_descendingKey(Process_floatKey(this->percent_cpu)); break;
    case PERCENT_MEM:
-      return (p2->m_resident - p1->m_resident);
-   case COMM:
-      return strcmp(p1->comm, p2->comm);
+   case M_RESIDENT:
+      *key = Process_descendingKey(Process_signedKey(this->m_resident)); break;
    case MAJFLT:
-      return (p2->majflt - p1->majflt);
+      *key = Process_descendingKey(Process_unsignedKey(this->majflt)); break;
    case MINFLT:
-      return (p2->minflt - p1->minflt);
-   case M_RESIDENT:
-      return (p2->m_resident - p1->m_resident);
+      *key = Process_descendingKey(Process_unsignedKey(this->minflt)); break;
    case M_SIZE:
-      return (p2->m_size - p1->m_size);
+      *key = Process_descendingKey(Process_signedKey(this->m_size)); break;
    case NICE:
-      return (p1->nice - p2->nice);
+      *key = Process_signedKey(this->nice); break;
    case NLWP:
-      return (p1->nlwp - p2->nlwp);
+      *key = Process_signedKey(this->nlwp); break;
    case PGRP:
-      return (p1->pgrp - p2->pgrp);
-   case PID:
-      return (p1->pid - p2->pid);
+      *key = Process_unsignedKey(this->pgrp); break;
    case PPID:
-      return (p1->ppid - p2->ppid);
+      *key = Process_signedKey(this->ppid); break;
    case PRIORITY:
-      return (p1->priority - p2->priority);
+      *key = Process_signedKey(this->priority); break;
    case PROCESSOR:
-      return (p1->processor - p2->processor);
+      *key = Process_signedKey(this->processor); break;
    case SESSION:
-      return (p1->session - p2->session);
-   case STARTTIME: {
-      if (p1->starttime_ctime == p2->starttime_ctime)
-         return (p1->pid - p2->pid);
-      else
-         return (p1->starttime_ctime - p2->starttime_ctime);
-   }
+      *key = Process_unsignedKey(this->session); break;
+   case STARTTIME:
+      *key = Process_signedKey(this->starttime_ctime); break;
    case STATE:
-      return (Process_sortState(p1->state) - Process_sortState(p2->state));
+      *key = Process_unsignedKey(Process_sortState(this->state)); break;
    case ST_UID:
-      return (p1->st_uid - p2->st_uid);
+      *key = Process_unsignedKey(this->st_uid); break;
    case TIME:
-      return ((p2->time) - (p1->time));
+      *key = Process_descendingKey(Process_unsignedKey(this->time)); break;
    case TGID:
-      return (p1->tgid - p2->tgid);
+      *key = Process_signedKey(this->tgid); break;
    case TPGID:
-      return (p1->tpgid - p2->tpgid);
+      *key = Process_signedKey(this->tpgid); break;
    case TTY_NR:
-      return (p1->tty_nr - p2->tty_nr);
+      *key = Process_unsignedKey(this->tty_nr); break;
+   case COMM:
    case USER:
-      return strcmp(p1->user ? p1->user : "", p2->user ? p2->user : "");
+      return false;
    default:
-      return (p1->pid - p2->pid);
+      // by PID only, as ties are
+      *key = 0; break;
    }
+   return true;
+}
+
+static Process_comparator(Process_comparePercentCpu, Process) {
+   return Process_compareNumbers(p2->percent_cpu, p1->percent_cpu);
+}
+
+static Process_comparator(Process_compareResident, Process) {
+   return Process_compareNumbers(p2->m_resident, p1->m_resident);
+}
+
+static Process_comparator(Process_compareComm, Process) {
+   return strcmp(p1->comm, p2->comm);
+}
+
+static Process_comparator(Process_compareMajflt, Process) {
+   return Process_compareNumbers(p2->majflt, p1->majflt);
+}
+
+static Process_comparator(Process_compareMinflt, Process) {
+   return Process_compareNumbers(p2->minflt, p1->minflt);
+}
+
+static Process_comparator(Process_compareSize, Process) {
+   return Process_compareNumbers(p2->m_size, p1->m_size);
+}
+
+static Process_comparator(Process_compareNice, Process) {
+   return Process_compareNumbers(p1->nice, p2->nice);
+}
+
+static Process_comparator(Process_compareNlwp, Process) {
+   return Process_compareNumbers(p1->nlwp, p2->nlwp);
+}
+
+static Process_comparator(Process_comparePgrp, Process) {
+   return Process_compareNumbers(p1->pgrp, p2->pgrp);
+}
+
+static Process_comparator(Process_comparePid, Process) {
+   return Process_compareNumbers(p1->pid, p2->pid);
+}
+
+static Process_comparator(Process_comparePpid, Process) {
+   return Process_compareNumbers(p1->ppid, p2->ppid);
+}
+
+static Process_comparator(Process_comparePriority, Process) {
+   return Process_compareNumbers(p1->priority, p2->priority);
+}
+
+static Process_comparator(Process_compareProcessor, Process) {
+   return Process_compareNumbers(p1->processor, p2->processor);
+}
+
+static Process_comparator(Process_compareSession, Process) {
+   return Process_compareNumbers(p1->session, p2->session);
+}
+
+static Process_comparator(Process_compareStartTime, Process) {
+   if (p1->starttime_ctime == p2->starttime_ctime)
+      return Process_compareNumbers(p1->pid, p2->pid);
+   return Process_compareNumbers(p1->starttime_ctime, p2->starttime_ctime);
+}
+
+static Process_comparator(Process_compareState, Process) {
+   return Process_sortState(p1->state) - Process_sortState(p2->state);
+}
+
+static Process_comparator(Process_compareUid, Process) {
+   return Process_compareNumbers(p1->st_uid, p2->st_uid);
+}
+
+static Process_comparator(Process_compareTime, Process) {
+   return Process_compareNumbers(p2->time, p1->time);
+}
+
+static Process_comparator(Process_compareTgid, Process) {
+   return Process_compareNumbers(p1->tgid, p2->tgid);
+}
+
+static Process_comparator(Process_compareTpgid, Process) {
+   return Process_compareNumbers(p1->tpgid, p2->tpgid);
+}
+
+static Process_comparator(Process_compareTty, Process) {
+   return Process_compareNumbers(p1->tty_nr, p2->tty_nr);
+}
+
+static Process_comparator(Process_compareUser, Process) {
+   return strcmp(p1->user ? p1->user : "", p2->user ? p2->user : "");
+}
+
+const Object_Compare Process_compareBy[][2] = {
+   [PERCENT_CPU] = Process_comparators(Process_comparePercentCpu),
+   [PERCENT_MEM] = Process_comparators(Process_compareResident),
+   [COMM] = Process_comparators(Process_compareComm),
+   [MAJFLT] = Process_comparators(Process_compareMajflt),
+   [MINFLT] = Process_comparators(Process_compareMinflt),
+   [M_RESIDENT] = Process_comparators(Process_compareResident),
+   [M_SIZE] = Process_comparators(Process_compareSize),
+   [NICE] = Process_comparators(Process_compareNice),
+   [NLWP] = Process_comparators(Process_compareNlwp),
+   [PGRP] = Process_comparators(Process_comparePgrp),
+   [PID] = Process_comparators(Process_comparePid),
+   [PPID] = Process_comparators(Process_comparePpid),
+   [PRIORITY] = Process_comparators(Process_comparePriority),
+   [PROCESSOR] = Process_comparators(Process_compareProcessor),
+   [SESSION] = Process_comparators(Process_compareSession),
+   [STARTTIME] = Process_comparators(Process_compareStartTime),
+   [STATE] = Process_comparators(Process_compareState),
+   [ST_UID] = Process_comparators(Process_compareUid),
+   [TIME] = Process_comparators(Process_compareTime),
+   [TGID] = Process_comparators(Process_compareTgid),
+   [TPGID] = Process_comparators(Process_compareTpgid),
+   [TTY_NR] = Process_comparators(Process_compareTty),
+   [USER] = Process_comparators(Process_compareUser),
+};
+
+long Process_compare(const void* v1, const void* v2) {
+   Settings *settings = ((Process*)v1)->settings;
+   unsigned int field = settings->sortKey;
+   if (field >= sizeof(Process_compareBy) / sizeof(Process_compareBy[0]) || !Process_compareBy[field][0])
+      field = PID;
+   return Process_compareBy[field][settings->direction == 1 ? 0 : 1](v1, v2);
+}
+
+/*
+ * Gives the comparator registered for the field in Process_fields, already
+ * mirrored for the direction, or NULL if the platform registers none.
+ */
+Object_Compare Process_getComparator(ProcessField field, int direction) {
+   const Object_Compare* compare = Process_fields[field].compare;
+   if (!compare)
+      return NULL;
+   return compare[direction == 1 ? 0 : 1];
+}
+
+static Object_Compare Process_sortChain[PROCESS_MAX_SORT_CHAIN];
+
+static int Process_sortChainLength = 0;
+
+static long Process_compareChained(const void* v1, const void* v2) {
+   for (int i = 0; i < Process_sortChainLength; i++) {
+      long result = Process_sortChain[i](v1, v2);
+      if (result)
+         return result;
+   }
+   return 0;
+}
+
+/*
+ * Combines comparators so that each one breaks the ties left by the ones
+ * before it. The combination holds until the next call.
+ */
+Object_Compare Process_chainComparators(const Object_Compare* chain, int count) {
+   assert(count > 0 && count <= PROCESS_MAX_SORT_CHAIN);
+   if (count == 1)
+      return chain[0];
+   for (int i = 0; i < count; i++)
+      Process_sortChain[i] = chain[i];
+   Process_sortChainLength = count;
+   return Process_compareChained;
 }
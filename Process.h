@@ -32,6 +32,11 @@ in the source distribution for its full text.
 
 #define PROCESS_FLAG_IO 0x0001
 
+// Process.changed bit for the values of the columns without PROCESS_FLAG_*
+#define PROCESS_CHANGED_BASE 0x40000000
+
+#define PROCESS_HOT_BYTES 64
+
 typedef enum ProcessFields {
    NULL_PROCESSFIELD = 0,
    PID = 1,
@@ -67,46 +72,50 @@ typedef struct ProcessPidColumn_ {
 typedef struct Process_ {
    Object super;
 
-   struct Settings_* settings;
-
+   // Hot block: the fields read by every scan and sort pass share the
+   // first cache line with the class pointer. Process_init checks that
+   // everything before settings fits in PROCESS_HOT_BYTES.
    unsigned long long int time;
    pid_t pid;
    pid_t ppid;
    pid_t tgid;
-   char* comm;
-   int commLen;
    int indent;
-
-   int basenameOffset;
-   bool updated;
-
+   float percent_cpu;
+   float percent_mem;
+   long m_resident;
    char state;
+   bool updated;
+   bool show;
    bool tag;
    bool showChildren;
-   bool show;
-   unsigned int pgrp;
-   unsigned int session;
-   unsigned int tty_nr;
-   int tpgid;
+   // on screen or near it, as of the last ProcessList_rebuildPanel
+   bool inView;
    uid_t st_uid;
-   unsigned long int flags;
-   int processor;
+   // PROCESS_FLAG_* groups of shown values changed since MainPanel last drew
+   // the row, with PROCESS_CHANGED_BASE for the rest of them
+   int changed;
 
-   float percent_cpu;
-   float percent_mem;
+   struct Settings_* settings;
+
+   char* comm;
+   int commLen;
+   int basenameOffset;
    char* user;
 
+   long m_size;
    long int priority;
    long int nice;
    long int nlwp;
+   int processor;
+   unsigned int pgrp;
+   unsigned int session;
+   unsigned int tty_nr;
+   int tpgid;
+   int exit_signal;
+   unsigned long int flags;
    char starttime_show[8];
    time_t starttime_ctime;
 
-   long m_size;
-   long m_resident;
-
-   int exit_signal;
-
    unsigned long int minflt;
    unsigned long int majflt;
    #ifdef DEBUG
@@ -135,6 +144,8 @@ typedef struct ProcessFieldData_ {
    const char* title;
    const char* description;
    int flags;
+   // comparators for direction 1 and its reverse, if the field has them
+   const Object_Compare* compare;
 } ProcessFieldData;
 
 // Implemented in platform-specific code:
@@ -148,10 +159,12 @@ extern char Process_pidFormat[20];
 
 typedef Process*(*Process_New)(struct Settings_*);
 typedef void (*Process_WriteField)(Process*, RichString*, ProcessField);
+typedef bool (*Process_SortKey)(const Process*, ProcessField, unsigned long long*);
 
 typedef struct ProcessClass_ {
    const ObjectClass super;
    const Process_WriteField writeField;
+   const Process_SortKey sortKey;
 } ProcessClass;
 
 #define As_Process(this_)              ((ProcessClass*)((this_)->super.klass))
@@ -162,6 +175,29 @@ typedef struct ProcessClass_ {
 
 #define Process_sortState(state) ((state) == 'I' ? 0x100 : (state))
 
+// Sort keys are unsigned and ascending: descending fields are inverted.
+#define Process_signedKey(v_)     ((unsigned long long)(long long)(v_) ^ 0x8000000000000000ULL)
+#define Process_unsignedKey(v_)   ((unsigned long long)(v_))
+#define Process_descendingKey(k_) (~(k_))
+
+#define Process_compareNumbers(a_, b_) (((a_) > (b_)) - ((a_) < (b_)))
+
+// Use as "static Process_comparator(name, type) { body }", where the body
+// compares p1 and p2: defines the comparator and its mirror, nameReversed.
+#define Process_comparator(name_, type_) \
+   long name_##Typed(const type_* p1, const type_* p2); \
+   static long name_(const void* v1, const void* v2) { \
+      return name_##Typed((const type_*) v1, (const type_*) v2); \
+   } \
+   static long name_##Reversed(const void* v1, const void* v2) { \
+      return name_##Typed((const type_*) v2, (const type_*) v1); \
+   } \
+   static inline long name_##Typed(const type_* p1, const type_* p2)
+
+#define Process_comparators(name_) { name_, name_##Reversed }
+
+#define PROCESS_MAX_SORT_CHAIN 4
+
 
 #define ONE_K 1024L
 #define ONE_M (ONE_K * ONE_K)
@@ -173,8 +209,13 @@ typedef struct ProcessClass_ {
 
 extern char Process_pidFormat[20];
 
+extern int Process_pidDigits;
+
 void Process_setupColumnWidths();
 
+/* writes pid as Process_pidFormat does, returning the length */
+int Process_formatPid(char* buffer, int pid);
+
 void Process_humanNumber(RichString* str, unsigned long number, bool coloring);
 
 void Process_colorNumber(RichString* str, unsigned long long number, bool coloring);
@@ -203,6 +244,28 @@ void Process_sendSignal(Process* this, int sgn);
 
 long Process_pidCompare(const void* v1, const void* v2);
 
+unsigned long long Process_floatKey(double value);
+
+/*
+ * Gives a key that orders processes by the field the way Process_compare
+ * does with direction 1, or false for fields compared as strings.
+ */
+bool Process_sortKey(const Process* this, ProcessField field, unsigned long long* key);
+
+extern const Object_Compare Process_compareBy[][2];
+
 long Process_compare(const void* v1, const void* v2);
 
+/*
+ * Gives the comparator registered for the field in Process_fields, already
+ * mirrored for the direction, or NULL if the platform registers none.
+ */
+Object_Compare Process_getComparator(ProcessField field, int direction);
+
+/*
+ * Combines comparators so that each one breaks the ties left by the ones
+ * before it. The combination holds until the next call.
+ */
+Object_Compare Process_chainComparators(const Object_Compare* chain, int count);
+
 #endif
@@ -39,10 +39,16 @@ typedef struct ProcessList_ {
 
    Vector* processes;
    Vector* processes2;
+   // how many leading processes are in their final order
+   int sorted;
    Hashtable* processTable;
    UsersTable* usersTable;
 
    Panel* panel;
+   // set by platforms that keep Process.changed up to date
+   bool tracksChanges;
+   // digest of the settings that rows are drawn from
+   unsigned int layout;
    int following;
    uid_t userId;
    const char* incFilter;
@@ -103,6 +109,9 @@ ProcessList* ProcessList_init(ProcessList* this, ObjectClass* klass, UsersTable*
 #endif
 
    this->following = -1;
+   this->sorted = 0;
+   this->tracksChanges = false;
+   this->layout = 0;
 
    return this;
 }
@@ -156,6 +165,7 @@ void ProcessList_remove(ProcessList* this, Process* p) {
    int idx = Vector_indexOf(this->processes, p, Process_pidCompare);
    assert(idx != -1);
    if (idx >= 0) Vector_remove(this->processes, idx);
+   if (idx < this->sorted) this->sorted--;
    assert(Hashtable_get(this->processTable, pid) == NULL); (void)pid;
    assert(Hashtable_count(this->processTable) == Vector_count(this->processes));
 }
@@ -168,40 +178,209 @@ int ProcessList_size(ProcessList* this) {
    return (Vector_size(this->processes));
 }
 
-static void ProcessList_buildTree(ProcessList* this, pid_t pid, int level, int indent, int direction, bool show) {
-   Vector* children = Vector_new(Class(Process), false, DEFAULT_SIZE);
-
-   for (int i = Vector_size(this->processes) - 1; i >= 0; i--) {
-      Process* process = (Process*) (Vector_get(this->processes, i));
-      if (process->show && Process_isChildOf(process, pid)) {
-         process = (Process*) (Vector_take(this->processes, i));
-         Vector_add(children, process);
+typedef struct TreeFrame_ {
+   int idx;
+   int level;
+   int indent;
+   bool show;
+} TreeFrame;
+
+static int ProcessList_findParent(Object** array, int size, Process* process) {
+   pid_t ppid = Process_getParentPid(process);
+   // If PID corresponds with PPID (e.g. "kernel_task" (PID:0, PPID:0)
+   // on Mac OS X 10.11.6) regard this process as root.
+   if (process->pid == ppid)
+      return -1;
+   // Bisect the PID-sorted array to find parent
+   int l = 0, r = size;
+   while (l < r) {
+      int c = (l + r) / 2;
+      pid_t pid = ((Process*)array[c])->pid;
+      if (ppid == pid) {
+         return c;
+      } else if (ppid < pid) {
+         r = c;
+      } else {
+         l = c + 1;
       }
    }
-   int size = Vector_size(children);
+   return -1;
+}
+
+static void ProcessList_buildTree(ProcessList* this, int direction) {
+   // Moves the PID-sorted processes vector into processes2 in tree order.
+   // Processes that are not shown, and processes whose parent is not in the
+   // list, become roots, visited in PID order. Children are indexed by parent
+   // once, in a CSR-style layout (the children of process i are
+   // children[offsets[i]] up to children[offsets[i+1]-1], in descending PID
+   // order), and each tree is emitted with an iterative depth-first walk.
+   // When sorting in reverse, descendants are prepended and roots appended.
+   int size = Vector_size(this->processes);
+   Object** array = this->processes->array;
+
+   int* parent = xMalloc(sizeof(int) * size);
+   int* offsets = xCalloc(size + 1, sizeof(int));
+   int* fill = xMalloc(sizeof(int) * size);
+   int* children = xMalloc(sizeof(int) * size);
+   Object** order = xMalloc(sizeof(Object*) * size);
+   TreeFrame* stack = xMalloc(sizeof(TreeFrame) * size);
+
+   int roots = 0;
    for (int i = 0; i < size; i++) {
-      Process* process = (Process*) (Vector_get(children, i));
-      if (!show)
-         process->show = false;
-      int s = this->processes2->items;
-      if (direction == 1)
-         Vector_add(this->processes2, process);
+      Process* process = (Process*) array[i];
+      parent[i] = process->show ? ProcessList_findParent(array, size, process) : -1;
+      if (parent[i] == -1)
+         roots++;
       else
-         Vector_insert(this->processes2, 0, process);
-      assert(this->processes2->items == s+1); (void)s;
-      int nextIndent = indent | (1 << level);
-      ProcessList_buildTree(this, process->pid, level+1, (i < size - 1) ? nextIndent : indent, direction, show ? process->showChildren : false);
-      if (i == size - 1)
-         process->indent = -nextIndent;
+         offsets[parent[i] + 1]++;
+   }
+   for (int i = 0; i < size; i++) {
+      offsets[i + 1] += offsets[i];
+      fill[i] = offsets[i];
+   }
+   for (int i = size - 1; i >= 0; i--) {
+      if (parent[i] != -1)
+         children[fill[parent[i]]++] = i;
+   }
+
+   int next = 0;
+   int nextRoot = size - roots;
+   int nextChild = size - roots - 1;
+   for (int r = 0; r < size; r++) {
+      if (parent[r] != -1)
+         continue;
+      Process* root = (Process*) array[r];
+      if (root->indent != 0) {
+         root->indent = 0;
+         root->changed |= PROCESS_CHANGED_BASE;
+      }
+      if (direction == 1)
+         order[next++] = array[r];
       else
-         process->indent = nextIndent;
+         order[nextRoot++] = array[r];
+      int sp = 0;
+      stack[sp++] = (TreeFrame) { .idx = r, .level = 0, .indent = 0, .show = root->show ? root->showChildren : false };
+      while (sp > 0) {
+         TreeFrame frame = stack[--sp];
+         if (frame.idx != r) {
+            if (direction == 1)
+               order[next++] = array[frame.idx];
+            else
+               order[nextChild--] = array[frame.idx];
+         }
+         int first = offsets[frame.idx];
+         int count = offsets[frame.idx + 1] - first;
+         int nextIndent = frame.indent | (1 << frame.level);
+         // push in reverse so that the first child is visited first
+         for (int i = count - 1; i >= 0; i--) {
+            Process* process = (Process*) array[children[first + i]];
+            if (!frame.show)
+               process->show = false;
+            int indent = (i == count - 1) ? -nextIndent : nextIndent;
+            if (process->indent != indent) {
+               process->indent = indent;
+               process->changed |= PROCESS_CHANGED_BASE;
+            }
+            stack[sp++] = (TreeFrame) {
+               .idx = children[first + i],
+               .level = frame.level + 1,
+               .indent = (i < count - 1) ? nextIndent : frame.indent,
+               .show = frame.show ? process->showChildren : false
+            };
+         }
+      }
+   }
+   // There should be no loop in the process tree
+   assert(direction == 1 ? next == size : (nextRoot == size && nextChild == -1));
+
+   Vector_addAll(this->processes2, order, size);
+   // processes2 owns them now
+   this->processes->items = 0;
+
+   free(parent);
+   free(offsets);
+   free(fill);
+   free(children);
+   free(order);
+   free(stack);
+}
+
+static bool ProcessList_sortByKeys(ProcessList* this, int start, int count) {
+   Process_SortKey sortKey = ((ProcessClass*) this->processes->type)->sortKey;
+   if (!sortKey)
+      return false;
+   ProcessField field = this->settings->sortKey;
+   bool ascending = (this->settings->direction == 1);
+   int size = Vector_size(this->processes) - start;
+   VectorSortKey* keys = xMalloc(size * sizeof(VectorSortKey));
+   for (int i = 0; i < size; i++) {
+      Process* p = (Process*) Vector_get(this->processes, start + i);
+      if (!sortKey(p, field, &keys[i].key)) {
+         free(keys);
+         return false;
+      }
+      // ties go by PID, in the same direction
+      keys[i].tie = p->pid;
+      if (!ascending) {
+         keys[i].key = ~keys[i].key;
+         keys[i].tie = ~keys[i].tie;
+      }
+      keys[i].item = (Object*) p;
    }
-   Vector_delete(children);
+   Vector_partialSortByKeys(this->processes, start, keys, count);
+   free(keys);
+   return true;
+}
+
+static inline bool ProcessList_isHidden(ProcessList* this, Process* p) {
+   return (!p->show)
+      || (this->userId != (uid_t) -1 && (p->st_uid != this->userId))
+      || (this->incFilter && !(String_contains_i(p->comm, this->incFilter)))
+      || (this->pidWhiteList && !Hashtable_get(this->pidWhiteList, p->tgid));
+}
+
+static Object_Compare ProcessList_comparator(ProcessList* this) {
+   ProcessField field = this->settings->sortKey;
+   int direction = this->settings->direction;
+   Object_Compare compare = Process_getComparator(field, direction);
+   Object_Compare byPid = Process_getComparator(PID, direction);
+   if (!compare || !byPid)
+      return this->processes->type->compare;
+   // ties go by PID, in the same direction, as with sort keys
+   Object_Compare chain[] = { compare, byPid };
+   return Process_chainComparators(chain, field == PID ? 1 : 2);
+}
+
+static void ProcessList_sortFrom(ProcessList* this, int start, int count) {
+   if (!ProcessList_sortByKeys(this, start, count))
+      Vector_partialSort(this->processes, start, count, ProcessList_comparator(this));
+   int size = Vector_size(this->processes);
+   this->sorted = MIN(start + count, size);
+}
+
+bool ProcessList_finishSort(ProcessList* this) {
+   int size = Vector_size(this->processes);
+   if (this->sorted >= size)
+      return false;
+   ProcessList_sortFrom(this, this->sorted, size - this->sorted);
+   return true;
 }
 
 void ProcessList_sort(ProcessList* this) {
    if (!this->settings->treeView) {
-      Vector_insertionSort(this->processes);
+      // Only the rows up to a page past the visible ones are put in order
+      // now; ProcessList_rebuildPanel finishes the job when more are needed.
+      int size = Vector_size(this->processes);
+      int count = size;
+      Panel* panel = this->panel;
+      if (panel && this->following == -1) {
+         count = MAX(panel->scrollV + panel->h, panel->selected + 1) + panel->h;
+         for (int i = 0; i < size && count < size; i++) {
+            if (ProcessList_isHidden(this, (Process*) Vector_get(this->processes, i)))
+               count++;
+         }
+      }
+      ProcessList_sortFrom(this, 0, count);
    } else {
       // Save settings
       int direction = this->settings->direction;
@@ -214,57 +393,15 @@ void ProcessList_sort(ProcessList* this) {
       this->settings->sortKey = sortKey;
       this->settings->direction = direction;
       int vsize = Vector_size(this->processes);
-      // Find all processes whose parent is not visible
-      int size;
-      while ((size = Vector_size(this->processes))) {
-         int i;
-         for (i = 0; i < size; i++) {
-            Process* process = (Process*)(Vector_get(this->processes, i));
-            // Immediately consume not shown processes
-            if (!process->show) {
-               process = (Process*)(Vector_take(this->processes, i));
-               process->indent = 0;
-               Vector_add(this->processes2, process);
-               ProcessList_buildTree(this, process->pid, 0, 0, direction, false);
-               break;
-            }
-            pid_t ppid = Process_getParentPid(process);
-            // Bisect the process vector to find parent
-            int l = 0, r = size;
-            // If PID corresponds with PPID (e.g. "kernel_task" (PID:0, PPID:0)
-            // on Mac OS X 10.11.6) cancel bisecting and regard this process as
-            // root.
-            if (process->pid == ppid)
-               r = 0;
-            while (l < r) {
-               int c = (l + r) / 2;
-               pid_t pid = ((Process*)(Vector_get(this->processes, c)))->pid;
-               if (ppid == pid) {
-                  break;
-               } else if (ppid < pid) {
-                  r = c;
-               } else {
-                  l = c + 1;
-               }
-            }
-            // If parent not found, then construct the tree with this root
-            if (l >= r) {
-               process = (Process*)(Vector_take(this->processes, i));
-               process->indent = 0;
-               Vector_add(this->processes2, process);
-               ProcessList_buildTree(this, process->pid, 0, 0, direction, process->showChildren);
-               break;
-            }
-         }
-         // There should be no loop in the process tree
-         assert(i < size);
-      }
+      assert(Vector_size(this->processes2) == 0);
+      ProcessList_buildTree(this, direction);
       assert(Vector_size(this->processes2) == vsize); (void)vsize;
       assert(Vector_size(this->processes) == 0);
       // Swap listings around
       Vector* t = this->processes;
       this->processes = this->processes2;
       this->processes2 = t;
+      this->sorted = Vector_size(this->processes);
    }
 }
 
@@ -290,38 +427,71 @@ void ProcessList_expandTree(ProcessList* this) {
    for (int i = 0; i < size; i++) {
       Process* process = (Process*) Vector_get(this->processes, i);
       process->showChildren = true;
+      process->changed |= PROCESS_CHANGED_BASE;
    }
 }
 
+static unsigned int ProcessList_layout(ProcessList* this) {
+   const Settings* settings = this->settings;
+   int options[] = {
+      settings->colorScheme, settings->direction, settings->cpuCount,
+      settings->treeView, settings->showProgramPath, settings->shadowOtherUsers, settings->showThreadNames,
+      settings->highlightBaseName, settings->highlightMegabytes, settings->highlightThreads,
+   };
+   unsigned int layout = 0;
+   for (unsigned int i = 0; i < sizeof(options) / sizeof(options[0]); i++)
+      layout = layout * 31 + options[i];
+   for (const ProcessField* field = settings->fields; *field; field++)
+      layout = layout * 31 + *field;
+   return layout;
+}
+
 void ProcessList_rebuildPanel(ProcessList* this) {
-   const char* incFilter = this->incFilter;
+   // rows drawn with other settings are drawn again
+   unsigned int layout = ProcessList_layout(this);
+   if (layout != this->layout) {
+      for (int i = 0; i < Vector_size(this->processes); i++)
+         ((Process*) Vector_get(this->processes, i))->changed = ~0;
+      this->layout = layout;
+   }
 
    int currPos = Panel_getSelectedIndex(this->panel);
    pid_t currPid = this->following != -1 ? this->following : 0;
    int currScrollV = this->panel->scrollV;
 
+   Panel* panel = this->panel;
+   int needed = MAX(currScrollV + panel->h, currPos + 1) + panel->h;
+   bool found = false;
+
    Panel_prune(this->panel);
    int size = ProcessList_size(this);
    int idx = 0;
    for (int i = 0; i < size; i++) {
-      bool hidden = false;
-      Process* p = ProcessList_get(this, i);
+      // the rest of a partial sort is only done when the panel gets there
+      if (i == this->sorted && (idx < needed || (this->following != -1 && !found)))
+         ProcessList_finishSort(this);
 
-      if ( (!p->show)
-         || (this->userId != (uid_t) -1 && (p->st_uid != this->userId))
-         || (incFilter && !(String_contains_i(p->comm, incFilter)))
-         || (this->pidWhiteList && !Hashtable_get(this->pidWhiteList, p->tgid)) )
-         hidden = true;
+      Process* p = ProcessList_get(this, i);
+      p->inView = false;
 
-      if (!hidden) {
+      if (!ProcessList_isHidden(this, p)) {
          Panel_set(this->panel, idx, (Object*)p);
          if ((this->following == -1 && idx == currPos) || (this->following != -1 && p->pid == currPid)) {
             Panel_setSelected(this->panel, idx);
             this->panel->scrollV = currScrollV;
+            needed = MAX(needed, idx + 1 + panel->h);
+            found = true;
          }
          idx++;
       }
    }
+
+   // The rows on screen, and a page of them on each side, are the ones
+   // whose expensive columns get collected on the next scans.
+   int first = MIN(panel->scrollV, panel->selected) - panel->h;
+   int last = MAX(panel->scrollV + panel->h, panel->selected + 1) + panel->h;
+   for (int i = MAX(first, 0); i < MIN(last, idx); i++)
+      ((Process*) Panel_get(panel, i))->inView = true;
 }
 
 Process* ProcessList_getProcess(ProcessList* this, pid_t pid, bool* preExisting, Process_New constructor) {
@@ -338,6 +508,28 @@ Process* ProcessList_getProcess(ProcessList* this, pid_t pid, bool* preExisting,
    return proc;
 }
 
+typedef struct ProcessList_Sweep_ {
+   ProcessList* this;
+   int i;
+   int sorted;
+} ProcessList_Sweep;
+
+static bool ProcessList_sweepGone(Object* cast, void* data) {
+   Process* p = (Process*) cast;
+   ProcessList_Sweep* sweep = (ProcessList_Sweep*) data;
+   bool gone = (p->updated == false);
+   if (gone) {
+      Process* pp = Hashtable_remove(sweep->this->processTable, p->pid);
+      assert(pp == p); (void)pp;
+      if (sweep->i < sweep->sorted)
+         sweep->this->sorted--;
+   } else {
+      p->updated = false;
+   }
+   sweep->i++;
+   return gone;
+}
+
 void ProcessList_scan(ProcessList* this) {
 
    // mark all process as "dirty"
@@ -354,11 +546,9 @@ void ProcessList_scan(ProcessList* this) {
 
    ProcessList_goThroughEntries(this);
    
-   for (int i = Vector_size(this->processes) - 1; i >= 0; i--) {
-      Process* p = (Process*) Vector_get(this->processes, i);
-      if (p->updated == false)
-         ProcessList_remove(this, p);
-      else
-         p->updated = false;
-   }
+   // drop the processes that are gone in a single pass,
+   // preserving the order of the remaining ones
+   ProcessList_Sweep sweep = { .this = this, .i = 0, .sorted = this->sorted };
+   Vector_removeIf(this->processes, ProcessList_sweepGone, &sweep);
+   assert(Hashtable_count(this->processTable) == Vector_count(this->processes));
 }
@@ -33,10 +33,16 @@ typedef struct ProcessList_ {
 
    Vector* processes;
    Vector* processes2;
+   // how many leading processes are in their final order
+   int sorted;
    Hashtable* processTable;
    UsersTable* usersTable;
 
    Panel* panel;
+   // set by platforms that keep Process.changed up to date
+   bool tracksChanges;
+   // digest of the settings that rows are drawn from
+   unsigned int layout;
    int following;
    uid_t userId;
    const char* incFilter;
@@ -87,6 +93,9 @@ Process* ProcessList_get(ProcessList* this, int idx);
 
 int ProcessList_size(ProcessList* this);
 
+
+bool ProcessList_finishSort(ProcessList* this);
+
 void ProcessList_sort(ProcessList* this);
 
 ProcessField ProcessList_keyAt(ProcessList* this, int at);
@@ -97,6 +106,7 @@ void ProcessList_rebuildPanel(ProcessList* this);
 
 Process* ProcessList_getProcess(ProcessList* this, pid_t pid, bool* preExisting, Process_New constructor);
 
+
 void ProcessList_scan(ProcessList* this);
 
 #endif
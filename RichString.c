@@ -93,15 +93,48 @@ static void RichString_extendLen(RichString* this, int len) {
 
 #ifdef HAVE_LIBNCURSESW
 
+#define RICHSTRING_ONES  (~(size_t)0 / 255)
+#define RICHSTRING_HIGHS (RICHSTRING_ONES * 0x80)
+
+static inline int RichString_asciiPrefix(const char* data, int len) {
+   // counts the leading ASCII bytes up to len or a NUL, a word at a time
+   // while no byte is zero or has its high bit set
+   int i = 0;
+   for (; i + (int) sizeof(size_t) <= len; i += sizeof(size_t)) {
+      size_t w;
+      memcpy(&w, data + i, sizeof(size_t));
+      if (((w - RICHSTRING_ONES) | w) & RICHSTRING_HIGHS)
+         break;
+   }
+   for (; i < len; i++) {
+      unsigned char c = data[i];
+      if (c == '\0' || c >= 128)
+         break;
+   }
+   return i;
+}
+
 static inline void RichString_writeFrom(RichString* this, int attrs, const char* data_c, int from, int len) {
-   wchar_t data[len+1];
-   len = mbstowcs(data, data_c, len);
-   if (len < 0)
-      return;
-   int newLen = from + len;
+   int ascii = RichString_asciiPrefix(data_c, len);
+   int wide = 0;
+   wchar_t data[ascii < len ? len - ascii + 1 : 1];
+   if (ascii < len && data_c[ascii] != '\0') {
+      wide = mbstowcs(data, data_c + ascii, len - ascii);
+      if (wide < 0)
+         return;
+   }
+   int newLen = from + ascii + wide;
    RichString_setLen(this, newLen);
-   for (int i = from, j = 0; i < newLen; i++, j++) {
-      this->chptr[i] = (CharType) { .attr = attrs & 0xffffff, .chars = { (iswprint(data[j]) ? data[j] : '?') } };
+   CharType* ch = this->chptr + from;
+   CharType cell = { .attr = attrs & 0xffffff };
+   for (int j = 0; j < ascii; j++) {
+      unsigned char c = data_c[j];
+      cell.chars[0] = (c >= 32 && c < 127) ? c : '?';
+      *ch++ = cell;
+   }
+   for (int j = 0; j < wide; j++) {
+      cell.chars[0] = iswprint(data[j]) ? data[j] : '?';
+      *ch++ = cell;
    }
 }
 
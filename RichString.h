@@ -69,6 +69,9 @@ typedef struct RichString_ {
 
 #ifdef HAVE_LIBNCURSESW
 
+#define RICHSTRING_ONES  (~(size_t)0 / 255)
+#define RICHSTRING_HIGHS (RICHSTRING_ONES * 0x80)
+
 extern void RichString_setAttrn(RichString* this, int attrs, int start, int finish);
 
 int RichString_findChar(RichString* this, char c, int start);
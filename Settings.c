@@ -19,10 +19,30 @@ in the source distribution for its full text.
 
 #define DEFAULT_DELAY 15
 
+#ifndef CLAMP
+#define CLAMP(x,low,high) (((x)>(high))?(high):(((x)<(low))?(low):(x)))
+#endif
+
 /*{
 #include "Process.h"
 #include <stdbool.h>
 
+#ifndef MAX_SCAN_THREADS
+#define MAX_SCAN_THREADS 256
+#endif
+
+#ifndef MAX_SLOW_REFRESH_PERIOD
+#define MAX_SLOW_REFRESH_PERIOD 100
+#endif
+
+#ifndef MAX_DELAYACCT_BUDGET
+#define MAX_DELAYACCT_BUDGET 1000
+#endif
+
+#ifndef DEFAULT_DELAYACCT_BUDGET
+#define DEFAULT_DELAYACCT_BUDGET 100
+#endif
+
 typedef struct {
    int len;
    char** names;
@@ -38,6 +58,9 @@ typedef struct Settings_ {
    int flags;
    int colorScheme;
    int delay;
+   int scanThreads;
+   int slowRefreshPeriod;
+   int delayAcctBudget;
 
    int cpuCount;
    int direction;
@@ -56,6 +79,7 @@ typedef struct Settings_ {
    bool highlightMegabytes;
    bool highlightThreads;
    bool updateProcessNames;
+   bool lowBandwidth;
    bool accountGuestInCPUMeter;
    bool headerMargin;
 
@@ -225,10 +249,18 @@ static bool Settings_read(Settings* this, const char* fileName) {
          this->countCPUsFromZero = atoi(option[1]);
       } else if (String_eq(option[0], "update_process_names")) {
          this->updateProcessNames = atoi(option[1]);
+      } else if (String_eq(option[0], "low_bandwidth")) {
+         this->lowBandwidth = atoi(option[1]);
       } else if (String_eq(option[0], "account_guest_in_cpu_meter")) {
          this->accountGuestInCPUMeter = atoi(option[1]);
       } else if (String_eq(option[0], "delay")) {
          this->delay = atoi(option[1]);
+      } else if (String_eq(option[0], "scan_threads")) {
+         this->scanThreads = CLAMP(atoi(option[1]), 1, MAX_SCAN_THREADS);
+      } else if (String_eq(option[0], "slow_refresh_period")) {
+         this->slowRefreshPeriod = CLAMP(atoi(option[1]), 1, MAX_SLOW_REFRESH_PERIOD);
+      } else if (String_eq(option[0], "delayacct_budget")) {
+         this->delayAcctBudget = CLAMP(atoi(option[1]), 0, MAX_DELAYACCT_BUDGET);
       } else if (String_eq(option[0], "color_scheme")) {
          this->colorScheme = atoi(option[1]);
          if (this->colorScheme < 0 || this->colorScheme >= LAST_COLORSCHEME) this->colorScheme = 0;
@@ -313,9 +345,13 @@ bool Settings_write(Settings* this) {
    fprintf(fd, "detailed_cpu_time=%d\n", (int) this->detailedCPUTime);
    fprintf(fd, "cpu_count_from_zero=%d\n", (int) this->countCPUsFromZero);
    fprintf(fd, "update_process_names=%d\n", (int) this->updateProcessNames);
+   fprintf(fd, "low_bandwidth=%d\n", (int) this->lowBandwidth);
    fprintf(fd, "account_guest_in_cpu_meter=%d\n", (int) this->accountGuestInCPUMeter);
    fprintf(fd, "color_scheme=%d\n", (int) this->colorScheme);
    fprintf(fd, "delay=%d\n", (int) this->delay);
+   fprintf(fd, "scan_threads=%d\n", (int) this->scanThreads);
+   fprintf(fd, "slow_refresh_period=%d\n", (int) this->slowRefreshPeriod);
+   fprintf(fd, "delayacct_budget=%d\n", (int) this->delayAcctBudget);
    fprintf(fd, "left_meters="); writeMeters(this, fd, 0);
    fprintf(fd, "left_meter_modes="); writeMeterModes(this, fd, 0);
    fprintf(fd, "right_meters="); writeMeters(this, fd, 1);
@@ -341,6 +377,7 @@ Settings* Settings_new(int cpuCount) {
    this->detailedCPUTime = false;
    this->countCPUsFromZero = false;
    this->updateProcessNames = false;
+   this->lowBandwidth = false;
    this->cpuCount = cpuCount;
    this->showProgramPath = true;
    this->highlightThreads = true;
@@ -392,6 +429,9 @@ Settings* Settings_new(int cpuCount) {
    this->colorScheme = 0;
    this->changed = false;
    this->delay = DEFAULT_DELAY;
+   this->scanThreads = 1;
+   this->slowRefreshPeriod = 1;
+   this->delayAcctBudget = DEFAULT_DELAYACCT_BUDGET;
    bool ok = false;
    if (legacyDotfile) {
       ok = Settings_read(this, legacyDotfile);
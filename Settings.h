@@ -11,9 +11,29 @@ in the source distribution for its full text.
 
 #define DEFAULT_DELAY 15
 
+#ifndef CLAMP
+#define CLAMP(x,low,high) (((x)>(high))?(high):(((x)<(low))?(low):(x)))
+#endif
+
 #include "Process.h"
 #include <stdbool.h>
 
+#ifndef MAX_SCAN_THREADS
+#define MAX_SCAN_THREADS 256
+#endif
+
+#ifndef MAX_SLOW_REFRESH_PERIOD
+#define MAX_SLOW_REFRESH_PERIOD 100
+#endif
+
+#ifndef MAX_DELAYACCT_BUDGET
+#define MAX_DELAYACCT_BUDGET 1000
+#endif
+
+#ifndef DEFAULT_DELAYACCT_BUDGET
+#define DEFAULT_DELAYACCT_BUDGET 100
+#endif
+
 typedef struct {
    int len;
    char** names;
@@ -29,6 +49,9 @@ typedef struct Settings_ {
    int flags;
    int colorScheme;
    int delay;
+   int scanThreads;
+   int slowRefreshPeriod;
+   int delayAcctBudget;
 
    int cpuCount;
    int direction;
@@ -47,6 +70,7 @@ typedef struct Settings_ {
    bool highlightMegabytes;
    bool highlightThreads;
    bool updateProcessNames;
+   bool lowBandwidth;
    bool accountGuestInCPUMeter;
    bool headerMargin;
 
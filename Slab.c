@@ -0,0 +1,127 @@
+/*
+htop - Slab.c
+(C) 2004-2011 Hisham H. Muhammad
+Released under the GNU GPL, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h"
+
+#include "Slab.h"
+#include "XAlloc.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/*{
+#include <stddef.h>
+#ifdef HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif
+
+typedef struct SlabChunk_ {
+   struct SlabChunk_* next;
+} SlabChunk;
+
+typedef struct Slab_ {
+   size_t size;
+   int perChunk;
+   SlabChunk* chunks;
+   // objects given back, linked through their first word
+   void* freeList;
+   // never used slots at the end of the newest chunk
+   char* unused;
+   char* end;
+   // allocations, allocations that took a new chunk, and frees, ever
+   unsigned long long allocs;
+   unsigned long long chunkAllocs;
+   unsigned long long frees;
+   #ifdef HAVE_LIBPTHREAD
+   pthread_mutex_t lock;
+   #endif
+} Slab;
+}*/
+
+/*
+ * Fixed-size objects are carved out of chunks of perChunk objects, and the
+ * ones freed are reused first. Chunks are only released by Slab_delete,
+ * so the memory held follows the peak object count.
+ */
+
+#define Slab_align(size_) (((size_) + sizeof(void*) - 1) & ~(sizeof(void*) - 1))
+
+Slab* Slab_new(size_t size, int perChunk) {
+   Slab* this = xCalloc(1, sizeof(Slab));
+   this->size = Slab_align(size < sizeof(void*) ? sizeof(void*) : size);
+   this->perChunk = perChunk;
+   #ifdef HAVE_LIBPTHREAD
+   pthread_mutex_init(&this->lock, NULL);
+   #endif
+   return this;
+}
+
+void Slab_delete(Slab* this) {
+   SlabChunk* chunk = this->chunks;
+   while (chunk) {
+      SlabChunk* next = chunk->next;
+      free(chunk);
+      chunk = next;
+   }
+   #ifdef HAVE_LIBPTHREAD
+   pthread_mutex_destroy(&this->lock);
+   #endif
+   free(this);
+}
+
+static inline void Slab_lock(Slab* this) {
+   #ifdef HAVE_LIBPTHREAD
+   pthread_mutex_lock(&this->lock);
+   #else
+   (void) this;
+   #endif
+}
+
+static inline void Slab_unlock(Slab* this) {
+   #ifdef HAVE_LIBPTHREAD
+   pthread_mutex_unlock(&this->lock);
+   #else
+   (void) this;
+   #endif
+}
+
+/* returns zeroed memory for one object */
+void* Slab_alloc(Slab* this) {
+   Slab_lock(this);
+   void* object;
+   if (this->freeList) {
+      object = this->freeList;
+      this->freeList = *(void**) object;
+   } else {
+      if (this->unused == this->end) {
+         size_t header = Slab_align(sizeof(SlabChunk));
+         SlabChunk* chunk = xMalloc(header + this->size * this->perChunk);
+         chunk->next = this->chunks;
+         this->chunks = chunk;
+         this->unused = (char*) chunk + header;
+         this->end = this->unused + this->size * this->perChunk;
+         this->chunkAllocs++;
+      }
+      object = this->unused;
+      this->unused += this->size;
+   }
+   this->allocs++;
+   Slab_unlock(this);
+   memset(object, 0, this->size);
+   return object;
+}
+
+void Slab_free(Slab* this, void* object) {
+   if (!object)
+      return;
+   Slab_lock(this);
+   *(void**) object = this->freeList;
+   this->freeList = object;
+   this->frees++;
+   Slab_unlock(this);
+}
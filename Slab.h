@@ -0,0 +1,56 @@
+/* Do not edit this file. It was automatically generated. */
+
+#ifndef HEADER_Slab
+#define HEADER_Slab
+/*
+htop - Slab.h
+(C) 2004-2011 Hisham H. Muhammad
+Released under the GNU GPL, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include <stddef.h>
+#ifdef HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif
+
+typedef struct SlabChunk_ {
+   struct SlabChunk_* next;
+} SlabChunk;
+
+typedef struct Slab_ {
+   size_t size;
+   int perChunk;
+   SlabChunk* chunks;
+   // objects given back, linked through their first word
+   void* freeList;
+   // never used slots at the end of the newest chunk
+   char* unused;
+   char* end;
+   // allocations, allocations that took a new chunk, and frees, ever
+   unsigned long long allocs;
+   unsigned long long chunkAllocs;
+   unsigned long long frees;
+   #ifdef HAVE_LIBPTHREAD
+   pthread_mutex_t lock;
+   #endif
+} Slab;
+
+/*
+ * Fixed-size objects are carved out of chunks of perChunk objects, and the
+ * ones freed are reused first. Chunks are only released by Slab_delete,
+ * so the memory held follows the peak object count.
+ */
+
+#define Slab_align(size_) (((size_) + sizeof(void*) - 1) & ~(sizeof(void*) - 1))
+
+Slab* Slab_new(size_t size, int perChunk);
+
+void Slab_delete(Slab* this);
+
+/* returns zeroed memory for one object */
+void* Slab_alloc(Slab* this);
+
+void Slab_free(Slab* this, void* object);
+
+#endif
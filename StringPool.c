@@ -0,0 +1,238 @@
+/*
+htop - StringPool.c
+(C) 2004-2011 Hisham H. Muhammad
+Released under the GNU GPL, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h"
+
+#include "StringPool.h"
+#include "XAlloc.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/*{
+#include <stddef.h>
+#include <stdbool.h>
+#ifdef HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif
+
+#ifndef STRINGPOOL_IDLE_GENERATIONS
+#define STRINGPOOL_IDLE_GENERATIONS 8
+#endif
+
+typedef struct StringPoolEntry_ {
+   struct StringPoolEntry_* next;
+   unsigned int hash;
+   int refs;
+   // generation at which refs last dropped to zero
+   unsigned int idleSince;
+   // position in the order of all entries, as of StringPool_updateRanks
+   int rank;
+   int len;
+   char text[];
+} StringPoolEntry;
+
+typedef struct StringPool_ {
+   StringPoolEntry** buckets;
+   int size;
+   int count;
+   unsigned int generation;
+   // entries were added since the last StringPool_updateRanks
+   bool ranksDirty;
+   // interns that found the string, interns that copied it, and entries
+   // freed by StringPool_sweep, ever
+   unsigned long long hits;
+   unsigned long long misses;
+   unsigned long long reclaimed;
+   #ifdef HAVE_LIBPTHREAD
+   pthread_mutex_t lock;
+   #endif
+} StringPool;
+
+#define StringPool_entry(text_) ((StringPoolEntry*) ((text_) - offsetof(StringPoolEntry, text)))
+
+// for strings returned by StringPool_intern
+#define StringPool_length(text_) (StringPool_entry(text_)->len)
+#define StringPool_rank(text_)   (StringPool_entry(text_)->rank)
+}*/
+
+/*
+ * Interned strings are shared and reference counted. An entry whose count
+ * drops to zero is kept for STRINGPOOL_IDLE_GENERATIONS calls to
+ * StringPool_sweep, so that strings which come and go with short-lived
+ * processes are not copied over and over again.
+ */
+
+StringPool* StringPool_new(void) {
+   StringPool* this = xCalloc(1, sizeof(StringPool));
+   this->size = 64;
+   this->buckets = xCalloc(this->size, sizeof(StringPoolEntry*));
+   #ifdef HAVE_LIBPTHREAD
+   pthread_mutex_init(&this->lock, NULL);
+   #endif
+   return this;
+}
+
+void StringPool_delete(StringPool* this) {
+   for (int i = 0; i < this->size; i++) {
+      StringPoolEntry* entry = this->buckets[i];
+      while (entry) {
+         StringPoolEntry* next = entry->next;
+         free(entry);
+         entry = next;
+      }
+   }
+   free(this->buckets);
+   #ifdef HAVE_LIBPTHREAD
+   pthread_mutex_destroy(&this->lock);
+   #endif
+   free(this);
+}
+
+static inline void StringPool_lock(StringPool* this) {
+   #ifdef HAVE_LIBPTHREAD
+   pthread_mutex_lock(&this->lock);
+   #else
+   (void) this;
+   #endif
+}
+
+static inline void StringPool_unlock(StringPool* this) {
+   #ifdef HAVE_LIBPTHREAD
+   pthread_mutex_unlock(&this->lock);
+   #else
+   (void) this;
+   #endif
+}
+
+unsigned int StringPool_hash(const char* text, int len) {
+   // FNV-1a
+   unsigned int hash = 2166136261u;
+   for (int i = 0; i < len; i++) {
+      hash ^= (unsigned char) text[i];
+      hash *= 16777619u;
+   }
+   return hash;
+}
+
+static void StringPool_grow(StringPool* this) {
+   int size = this->size * 2;
+   StringPoolEntry** buckets = xCalloc(size, sizeof(StringPoolEntry*));
+   for (int i = 0; i < this->size; i++) {
+      StringPoolEntry* entry = this->buckets[i];
+      while (entry) {
+         StringPoolEntry* next = entry->next;
+         int idx = entry->hash & (size - 1);
+         entry->next = buckets[idx];
+         buckets[idx] = entry;
+         entry = next;
+      }
+   }
+   free(this->buckets);
+   this->buckets = buckets;
+   this->size = size;
+}
+
+/* returns a shared copy of the first len bytes of text, to be released */
+const char* StringPool_intern(StringPool* this, const char* text, int len) {
+   unsigned int hash = StringPool_hash(text, len);
+   StringPool_lock(this);
+   StringPoolEntry* entry = this->buckets[hash & (this->size - 1)];
+   while (entry) {
+      if (entry->hash == hash && entry->len == len && memcmp(entry->text, text, len) == 0)
+         break;
+      entry = entry->next;
+   }
+   if (entry) {
+      this->hits++;
+   } else {
+      if (this->count >= this->size)
+         StringPool_grow(this);
+      entry = xMalloc(sizeof(StringPoolEntry) + len + 1);
+      entry->hash = hash;
+      entry->refs = 0;
+      entry->rank = 0;
+      entry->len = len;
+      memcpy(entry->text, text, len);
+      entry->text[len] = '\0';
+      int idx = hash & (this->size - 1);
+      entry->next = this->buckets[idx];
+      this->buckets[idx] = entry;
+      this->count++;
+      this->misses++;
+      this->ranksDirty = true;
+   }
+   entry->refs++;
+   StringPool_unlock(this);
+   return entry->text;
+}
+
+void StringPool_release(StringPool* this, const char* text) {
+   if (!text)
+      return;
+   StringPoolEntry* entry = StringPool_entry(text);
+   StringPool_lock(this);
+   assert(entry->refs > 0);
+   entry->refs--;
+   if (entry->refs == 0)
+      entry->idleSince = this->generation;
+   StringPool_unlock(this);
+}
+
+/* starts a new generation, freeing the entries idle for long enough */
+int StringPool_sweep(StringPool* this) {
+   int freed = 0;
+   StringPool_lock(this);
+   this->generation++;
+   for (int i = 0; i < this->size; i++) {
+      StringPoolEntry** link = &(this->buckets[i]);
+      while (*link) {
+         StringPoolEntry* entry = *link;
+         if (entry->refs == 0 && this->generation - entry->idleSince >= STRINGPOOL_IDLE_GENERATIONS) {
+            *link = entry->next;
+            free(entry);
+            freed++;
+         } else {
+            link = &(entry->next);
+         }
+      }
+   }
+   this->count -= freed;
+   this->reclaimed += freed;
+   StringPool_unlock(this);
+   return freed;
+}
+
+static int StringPool_compareEntries(const void* v1, const void* v2) {
+   const StringPoolEntry* e1 = *(const StringPoolEntry* const*) v1;
+   const StringPoolEntry* e2 = *(const StringPoolEntry* const*) v2;
+   return strcmp(e1->text, e2->text);
+}
+
+/*
+ * Numbers the entries in strcmp order, so that interned strings compare
+ * as their ranks do. The empty string, and only it, gets rank 0.
+ */
+void StringPool_updateRanks(StringPool* this) {
+   StringPool_lock(this);
+   if (this->ranksDirty) {
+      StringPoolEntry** entries = xMalloc(sizeof(StringPoolEntry*) * (this->count + 1));
+      int n = 0;
+      for (int i = 0; i < this->size; i++) {
+         for (StringPoolEntry* entry = this->buckets[i]; entry; entry = entry->next)
+            entries[n++] = entry;
+      }
+      assert(n == this->count);
+      qsort(entries, n, sizeof(StringPoolEntry*), StringPool_compareEntries);
+      for (int i = 0; i < n; i++)
+         entries[i]->rank = entries[i]->len == 0 ? 0 : i + 1;
+      free(entries);
+      this->ranksDirty = false;
+   }
+   StringPool_unlock(this);
+}
@@ -0,0 +1,84 @@
+/* Do not edit this file. It was automatically generated. */
+
+#ifndef HEADER_StringPool
+#define HEADER_StringPool
+/*
+htop - StringPool.h
+(C) 2004-2011 Hisham H. Muhammad
+Released under the GNU GPL, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include <stddef.h>
+#include <stdbool.h>
+#ifdef HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif
+
+#ifndef STRINGPOOL_IDLE_GENERATIONS
+#define STRINGPOOL_IDLE_GENERATIONS 8
+#endif
+
+typedef struct StringPoolEntry_ {
+   struct StringPoolEntry_* next;
+   unsigned int hash;
+   int refs;
+   // generation at which refs last dropped to zero
+   unsigned int idleSince;
+   // position in the order of all entries, as of StringPool_updateRanks
+   int rank;
+   int len;
+   char text[];
+} StringPoolEntry;
+
+typedef struct StringPool_ {
+   StringPoolEntry** buckets;
+   int size;
+   int count;
+   unsigned int generation;
+   // entries were added since the last StringPool_updateRanks
+   bool ranksDirty;
+   // interns that found the string, interns that copied it, and entries
+   // freed by StringPool_sweep, ever
+   unsigned long long hits;
+   unsigned long long misses;
+   unsigned long long reclaimed;
+   #ifdef HAVE_LIBPTHREAD
+   pthread_mutex_t lock;
+   #endif
+} StringPool;
+
+#define StringPool_entry(text_) ((StringPoolEntry*) ((text_) - offsetof(StringPoolEntry, text)))
+
+// for strings returned by StringPool_intern
+#define StringPool_length(text_) (StringPool_entry(text_)->len)
+#define StringPool_rank(text_)   (StringPool_entry(text_)->rank)
+
+/*
+ * Interned strings are shared and reference counted. An entry whose count
+ * drops to zero is kept for STRINGPOOL_IDLE_GENERATIONS calls to
+ * StringPool_sweep, so that strings which come and go with short-lived
+ * processes are not copied over and over again.
+ */
+
+StringPool* StringPool_new(void);
+
+void StringPool_delete(StringPool* this);
+
+unsigned int StringPool_hash(const char* text, int len);
+
+/* returns a shared copy of the first len bytes of text, to be released */
+const char* StringPool_intern(StringPool* this, const char* text, int len);
+
+void StringPool_release(StringPool* this, const char* text);
+
+/* starts a new generation, freeing the entries idle for long enough */
+int StringPool_sweep(StringPool* this);
+
+/*
+ * Numbers the entries in strcmp order, so that interned strings compare
+ * as their ranks do. The empty string, and only it, gets rank 0.
+ */
+void StringPool_updateRanks(StringPool* this);
+
+#endif
@@ -12,6 +12,7 @@ in the source distribution for its full text.
 
 #include <string.h>
 #include <strings.h>
+#include <stdbool.h>
 #include <stdlib.h>
 
 /*{
@@ -154,3 +155,68 @@ char* String_readLine(FILE* fd) {
       at = buffer + bufSize - step;
    }
 }
+
+static const char String_digitPairs[] = {
+   "00010203040506070809"
+   "10111213141516171819"
+   "20212223242526272829"
+   "30313233343536373839"
+   "40414243444546474849"
+   "50515253545556575859"
+   "60616263646566676869"
+   "70717273747576777879"
+   "80818283848586878889"
+   "90919293949596979899"
+};
+
+static int String_formatDigits(char* buffer, unsigned long long value, bool negative, int decimals, int width) {
+   char digits[24];
+   char* at = digits + sizeof(digits);
+   for (int i = 0; i < decimals; i++) {
+      *--at = '0' + value % 10;
+      value /= 10;
+   }
+   if (decimals > 0)
+      *--at = '.';
+   while (value >= 100) {
+      const char* pair = String_digitPairs + (value % 100) * 2;
+      value /= 100;
+      *--at = pair[1];
+      *--at = pair[0];
+   }
+   if (value >= 10) {
+      const char* pair = String_digitPairs + value * 2;
+      *--at = pair[1];
+      *--at = pair[0];
+   } else {
+      *--at = '0' + value;
+   }
+   if (negative)
+      *--at = '-';
+   int len = digits + sizeof(digits) - at;
+   int pad = width > len ? width - len : 0;
+   memset(buffer, ' ', pad);
+   memcpy(buffer + pad, at, len);
+   buffer[pad + len] = '\0';
+   return pad + len;
+}
+
+/*
+ * These write a number as printf's %*llu, %*lld and %*.*f would, right
+ * aligned in at least width columns, and return the length written.
+ * String_formatFixed takes the value already multiplied by 10^decimals.
+ */
+
+int String_formatUnsigned(char* buffer, unsigned long long value, int width) {
+   return String_formatDigits(buffer, value, false, 0, width);
+}
+
+int String_formatSigned(char* buffer, long long value, int width) {
+   if (value < 0)
+      return String_formatDigits(buffer, -(unsigned long long) value, true, 0, width);
+   return String_formatDigits(buffer, value, false, 0, width);
+}
+
+int String_formatFixed(char* buffer, unsigned long long scaled, int decimals, int width) {
+   return String_formatDigits(buffer, scaled, false, decimals, width);
+}
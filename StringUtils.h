@@ -33,4 +33,16 @@ char* String_getToken(const char* line, const unsigned short int numMatch);
 
 char* String_readLine(FILE* fd);
 
+/*
+ * These write a number as printf's %*llu, %*lld and %*.*f would, right
+ * aligned in at least width columns, and return the length written.
+ * String_formatFixed takes the value already multiplied by 10^decimals.
+ */
+
+int String_formatUnsigned(char* buffer, unsigned long long value, int width);
+
+int String_formatSigned(char* buffer, long long value, int width);
+
+int String_formatFixed(char* buffer, unsigned long long scaled, int decimals, int width);
+
 #endif
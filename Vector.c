@@ -21,6 +21,10 @@ in the source distribution for its full text.
 #define DEFAULT_SIZE -1
 #endif
 
+#ifndef MAX
+#define MAX(a,b) ((a)>(b)?(a):(b))
+#endif
+
 typedef struct Vector_ {
    Object **array;
    ObjectClass* type;
@@ -28,8 +32,18 @@ typedef struct Vector_ {
    int growthRate;
    int items;
    bool owner;
+   // free slots allocated before array, used by Vector_prepend
+   int head;
 } Vector;
 
+typedef bool(*Vector_Predicate)(Object*, void*);
+
+typedef struct VectorSortKey_ {
+   unsigned long long key;
+   unsigned int tie;
+   Object* item;
+} VectorSortKey;
+
 }*/
 
 Vector* Vector_new(ObjectClass* type, bool owner, int size) {
@@ -44,6 +58,7 @@ Vector* Vector_new(ObjectClass* type, bool owner, int size) {
    this->items = 0;
    this->type = type;
    this->owner = owner;
+   this->head = 0;
    return this;
 }
 
@@ -53,7 +68,7 @@ void Vector_delete(Vector* this) {
          if (this->array[i])
             Object_delete(this->array[i]);
    }
-   free(this->array);
+   free(this->array - this->head);
    free(this);
 }
 
@@ -61,6 +76,7 @@ void Vector_delete(Vector* this) {
 
 static inline bool Vector_isConsistent(Vector* this) {
    assert(this->items <= this->arraySize);
+   assert(this->head >= 0);
    if (this->owner) {
       for (int i = 0; i < this->items; i++)
          if (this->array[i] && !Object_isA(this->array[i], this->type))
@@ -93,6 +109,10 @@ void Vector_prune(Vector* this) {
          }
    }
    this->items = 0;
+   // give the slots left by Vector_prepend back to the end
+   this->array -= this->head;
+   this->arraySize += this->head;
+   this->head = 0;
 }
 
 static int comparisons = 0;
@@ -144,45 +164,687 @@ static void combSort(Object** array, int left, int right, Object_Compare compare
 
 */
 
-static void insertionSort(Object** array, int left, int right, Object_Compare compare) {
-   for (int i = left+1; i <= right; i++) {
-      void* t = array[i];
-      int j = i - 1;
-      while (j >= left) {
-         comparisons++;
-         if (compare(array[j], t) <= 0)
-            break;
-         array[j+1] = array[j];
-         j--;
+void Vector_quickSort(Vector* this) {
+   assert(this->type->compare);
+   assert(Vector_isConsistent(this));
+   quickSort(this->array, 0, this->items - 1, this->type->compare);
+   assert(Vector_isConsistent(this));
+}
+
+#define VECTOR_MIN_MERGE 32
+#define VECTOR_MIN_GALLOP 7
+#define VECTOR_MAX_RUNS 85
+
+typedef struct VectorMergeState_ {
+   Object** array;
+   Object_Compare compare;
+   Object** tmp;
+   int tmpSize;
+   int minGallop;
+   int runs;
+   int runBase[VECTOR_MAX_RUNS];
+   int runLen[VECTOR_MAX_RUNS];
+} VectorMergeState;
+
+static inline long compareCounted(Object_Compare compare, const void* a, const void* b) {
+   comparisons++;
+   return compare(a, b);
+}
+
+static int minRunLength(int n) {
+   int r = 0;
+   while (n >= VECTOR_MIN_MERGE) {
+      r |= (n & 1);
+      n >>= 1;
+   }
+   return n + r;
+}
+
+static void binaryInsertionSort(Object** array, int lo, int hi, int start, Object_Compare compare) {
+   // [lo, start) is already sorted
+   if (start == lo)
+      start++;
+   for (; start < hi; start++) {
+      Object* pivot = array[start];
+      int left = lo;
+      int right = start;
+      while (left < right) {
+         int mid = (left + right) >> 1;
+         if (compareCounted(compare, pivot, array[mid]) < 0)
+            right = mid;
+         else
+            left = mid + 1;
       }
-      array[j+1] = t;
+      memmove(&array[left + 1], &array[left], (start - left) * sizeof(Object*));
+      array[left] = pivot;
    }
 }
 
-void Vector_quickSort(Vector* this) {
+static int countRunAndMakeAscending(Object** array, int lo, int hi, Object_Compare compare) {
+   int runHi = lo + 1;
+   if (runHi == hi)
+      return 1;
+   if (compareCounted(compare, array[runHi++], array[lo]) < 0) {
+      // only strictly descending runs are reversed, so stability holds
+      while (runHi < hi && compareCounted(compare, array[runHi], array[runHi - 1]) < 0)
+         runHi++;
+      for (int i = lo, j = runHi - 1; i < j; i++, j--)
+         swap(array, i, j);
+   } else {
+      while (runHi < hi && compareCounted(compare, array[runHi], array[runHi - 1]) >= 0)
+         runHi++;
+   }
+   return runHi - lo;
+}
+
+static int gallopLeft(Object* key, Object** array, int len, int hint, Object_Compare compare) {
+   // returns k such that array[k - 1] < key <= array[k]
+   int lastOfs = 0;
+   int ofs = 1;
+   if (compareCounted(compare, key, array[hint]) > 0) {
+      int maxOfs = len - hint;
+      while (ofs < maxOfs && compareCounted(compare, key, array[hint + ofs]) > 0) {
+         lastOfs = ofs;
+         ofs = (ofs << 1) + 1;
+         if (ofs <= 0)
+            ofs = maxOfs;
+      }
+      if (ofs > maxOfs)
+         ofs = maxOfs;
+      lastOfs += hint;
+      ofs += hint;
+   } else {
+      int maxOfs = hint + 1;
+      while (ofs < maxOfs && compareCounted(compare, key, array[hint - ofs]) <= 0) {
+         lastOfs = ofs;
+         ofs = (ofs << 1) + 1;
+         if (ofs <= 0)
+            ofs = maxOfs;
+      }
+      if (ofs > maxOfs)
+         ofs = maxOfs;
+      int t = lastOfs;
+      lastOfs = hint - ofs;
+      ofs = hint - t;
+   }
+   lastOfs++;
+   while (lastOfs < ofs) {
+      int m = lastOfs + ((ofs - lastOfs) >> 1);
+      if (compareCounted(compare, key, array[m]) > 0)
+         lastOfs = m + 1;
+      else
+         ofs = m;
+   }
+   return ofs;
+}
+
+static int gallopRight(Object* key, Object** array, int len, int hint, Object_Compare compare) {
+   // returns k such that array[k - 1] <= key < array[k]
+   int lastOfs = 0;
+   int ofs = 1;
+   if (compareCounted(compare, key, array[hint]) < 0) {
+      int maxOfs = hint + 1;
+      while (ofs < maxOfs && compareCounted(compare, key, array[hint - ofs]) < 0) {
+         lastOfs = ofs;
+         ofs = (ofs << 1) + 1;
+         if (ofs <= 0)
+            ofs = maxOfs;
+      }
+      if (ofs > maxOfs)
+         ofs = maxOfs;
+      int t = lastOfs;
+      lastOfs = hint - ofs;
+      ofs = hint - t;
+   } else {
+      int maxOfs = len - hint;
+      while (ofs < maxOfs && compareCounted(compare, key, array[hint + ofs]) >= 0) {
+         lastOfs = ofs;
+         ofs = (ofs << 1) + 1;
+         if (ofs <= 0)
+            ofs = maxOfs;
+      }
+      if (ofs > maxOfs)
+         ofs = maxOfs;
+      lastOfs += hint;
+      ofs += hint;
+   }
+   lastOfs++;
+   while (lastOfs < ofs) {
+      int m = lastOfs + ((ofs - lastOfs) >> 1);
+      if (compareCounted(compare, key, array[m]) < 0)
+         ofs = m;
+      else
+         lastOfs = m + 1;
+   }
+   return ofs;
+}
+
+static Object** VectorMergeState_tmp(VectorMergeState* ms, int size) {
+   if (ms->tmpSize < size) {
+      ms->tmpSize = size;
+      ms->tmp = xRealloc(ms->tmp, size * sizeof(Object*));
+   }
+   return ms->tmp;
+}
+
+static void mergeLo(VectorMergeState* ms, int base1, int len1, int base2, int len2) {
+   // the first run is the shorter one: move it aside and merge from the left
+   Object** a = ms->array;
+   Object** tmp = VectorMergeState_tmp(ms, len1);
+   Object_Compare compare = ms->compare;
+   memcpy(tmp, &a[base1], len1 * sizeof(Object*));
+   int cursor1 = 0;
+   int cursor2 = base2;
+   int dest = base1;
+   a[dest++] = a[cursor2++];
+   if (--len2 == 0) {
+      memcpy(&a[dest], &tmp[cursor1], len1 * sizeof(Object*));
+      return;
+   }
+   if (len1 == 1) {
+      memmove(&a[dest], &a[cursor2], len2 * sizeof(Object*));
+      a[dest + len2] = tmp[cursor1];
+      return;
+   }
+   int minGallop = ms->minGallop;
+   for (;;) {
+      int count1 = 0;
+      int count2 = 0;
+      do {
+         if (compareCounted(compare, a[cursor2], tmp[cursor1]) < 0) {
+            a[dest++] = a[cursor2++];
+            count2++;
+            count1 = 0;
+            if (--len2 == 0)
+               goto done;
+         } else {
+            a[dest++] = tmp[cursor1++];
+            count1++;
+            count2 = 0;
+            if (--len1 == 1)
+               goto done;
+         }
+      } while ((count1 | count2) < minGallop);
+      // one run keeps winning: switch to galloping until it stops paying off
+      do {
+         count1 = gallopRight(a[cursor2], &tmp[cursor1], len1, 0, compare);
+         if (count1 != 0) {
+            memcpy(&a[dest], &tmp[cursor1], count1 * sizeof(Object*));
+            dest += count1;
+            cursor1 += count1;
+            len1 -= count1;
+            if (len1 <= 1)
+               goto done;
+         }
+         a[dest++] = a[cursor2++];
+         if (--len2 == 0)
+            goto done;
+         count2 = gallopLeft(tmp[cursor1], &a[cursor2], len2, 0, compare);
+         if (count2 != 0) {
+            memmove(&a[dest], &a[cursor2], count2 * sizeof(Object*));
+            dest += count2;
+            cursor2 += count2;
+            len2 -= count2;
+            if (len2 == 0)
+               goto done;
+         }
+         a[dest++] = tmp[cursor1++];
+         if (--len1 == 1)
+            goto done;
+         minGallop--;
+      } while (count1 >= VECTOR_MIN_GALLOP || count2 >= VECTOR_MIN_GALLOP);
+      if (minGallop < 0)
+         minGallop = 0;
+      minGallop += 2;
+   }
+done:
+   ms->minGallop = minGallop < 1 ? 1 : minGallop;
+   if (len1 == 1) {
+      memmove(&a[dest], &a[cursor2], len2 * sizeof(Object*));
+      a[dest + len2] = tmp[cursor1];
+   } else {
+      assert(len1 > 1 && len2 == 0);
+      memcpy(&a[dest], &tmp[cursor1], len1 * sizeof(Object*));
+   }
+}
+
+static void mergeHi(VectorMergeState* ms, int base1, int len1, int base2, int len2) {
+   // the second run is the shorter one: move it aside and merge from the right
+   Object** a = ms->array;
+   Object** tmp = VectorMergeState_tmp(ms, len2);
+   Object_Compare compare = ms->compare;
+   memcpy(tmp, &a[base2], len2 * sizeof(Object*));
+   int cursor1 = base1 + len1 - 1;
+   int cursor2 = len2 - 1;
+   int dest = base2 + len2 - 1;
+   a[dest--] = a[cursor1--];
+   if (--len1 == 0) {
+      memcpy(&a[dest - (len2 - 1)], tmp, len2 * sizeof(Object*));
+      return;
+   }
+   if (len2 == 1) {
+      dest -= len1;
+      cursor1 -= len1;
+      memmove(&a[dest + 1], &a[cursor1 + 1], len1 * sizeof(Object*));
+      a[dest] = tmp[cursor2];
+      return;
+   }
+   int minGallop = ms->minGallop;
+   for (;;) {
+      int count1 = 0;
+      int count2 = 0;
+      do {
+         if (compareCounted(compare, tmp[cursor2], a[cursor1]) < 0) {
+            a[dest--] = a[cursor1--];
+            count1++;
+            count2 = 0;
+            if (--len1 == 0)
+               goto done;
+         } else {
+            a[dest--] = tmp[cursor2--];
+            count2++;
+            count1 = 0;
+            if (--len2 == 1)
+               goto done;
+         }
+      } while ((count1 | count2) < minGallop);
+      do {
+         count1 = len1 - gallopRight(tmp[cursor2], &a[base1], len1, len1 - 1, compare);
+         if (count1 != 0) {
+            dest -= count1;
+            cursor1 -= count1;
+            len1 -= count1;
+            memmove(&a[dest + 1], &a[cursor1 + 1], count1 * sizeof(Object*));
+            if (len1 == 0)
+               goto done;
+         }
+         a[dest--] = tmp[cursor2--];
+         if (--len2 == 1)
+            goto done;
+         count2 = len2 - gallopLeft(a[cursor1], tmp, len2, len2 - 1, compare);
+         if (count2 != 0) {
+            dest -= count2;
+            cursor2 -= count2;
+            len2 -= count2;
+            memcpy(&a[dest + 1], &tmp[cursor2 + 1], count2 * sizeof(Object*));
+            if (len2 <= 1)
+               goto done;
+         }
+         a[dest--] = a[cursor1--];
+         if (--len1 == 0)
+            goto done;
+         minGallop--;
+      } while (count1 >= VECTOR_MIN_GALLOP || count2 >= VECTOR_MIN_GALLOP);
+      if (minGallop < 0)
+         minGallop = 0;
+      minGallop += 2;
+   }
+done:
+   ms->minGallop = minGallop < 1 ? 1 : minGallop;
+   if (len2 == 1) {
+      dest -= len1;
+      cursor1 -= len1;
+      memmove(&a[dest + 1], &a[cursor1 + 1], len1 * sizeof(Object*));
+      a[dest] = tmp[cursor2];
+   } else {
+      assert(len2 > 1 && len1 == 0);
+      memcpy(&a[dest - (len2 - 1)], tmp, len2 * sizeof(Object*));
+   }
+}
+
+static void mergeAt(VectorMergeState* ms, int i) {
+   Object** a = ms->array;
+   int base1 = ms->runBase[i];
+   int len1 = ms->runLen[i];
+   int base2 = ms->runBase[i + 1];
+   int len2 = ms->runLen[i + 1];
+   ms->runLen[i] = len1 + len2;
+   if (i == ms->runs - 3) {
+      ms->runBase[i + 1] = ms->runBase[i + 2];
+      ms->runLen[i + 1] = ms->runLen[i + 2];
+   }
+   ms->runs--;
+   // items of the first run that are already in place stay where they are
+   int k = gallopRight(a[base2], &a[base1], len1, 0, ms->compare);
+   base1 += k;
+   len1 -= k;
+   if (len1 == 0)
+      return;
+   // and so do items of the second run that are already in place
+   len2 = gallopLeft(a[base1 + len1 - 1], &a[base2], len2, len2 - 1, ms->compare);
+   if (len2 == 0)
+      return;
+   if (len1 <= len2)
+      mergeLo(ms, base1, len1, base2, len2);
+   else
+      mergeHi(ms, base1, len1, base2, len2);
+}
+
+static void mergeCollapse(VectorMergeState* ms) {
+   // keeps run lengths decreasing faster than the Fibonacci numbers,
+   // which bounds the stack depth and keeps merges balanced
+   int* runLen = ms->runLen;
+   while (ms->runs > 1) {
+      int n = ms->runs - 2;
+      if ((n > 0 && runLen[n - 1] <= runLen[n] + runLen[n + 1])
+       || (n > 1 && runLen[n - 2] <= runLen[n - 1] + runLen[n])) {
+         if (runLen[n - 1] < runLen[n + 1])
+            n--;
+      } else if (runLen[n] > runLen[n + 1]) {
+         break;
+      }
+      mergeAt(ms, n);
+   }
+}
+
+static void mergeForceCollapse(VectorMergeState* ms) {
+   while (ms->runs > 1) {
+      int n = ms->runs - 2;
+      if (n > 0 && ms->runLen[n - 1] < ms->runLen[n + 1])
+         n--;
+      mergeAt(ms, n);
+   }
+}
+
+static void timSort(Object** array, int n, Object_Compare compare) {
+   if (n < 2)
+      return;
+   if (n < VECTOR_MIN_MERGE) {
+      int runLen = countRunAndMakeAscending(array, 0, n, compare);
+      binaryInsertionSort(array, 0, n, runLen, compare);
+      return;
+   }
+   VectorMergeState ms = {
+      .array = array,
+      .compare = compare,
+      .tmp = NULL,
+      .tmpSize = 0,
+      .minGallop = VECTOR_MIN_GALLOP,
+      .runs = 0
+   };
+   int minRun = minRunLength(n);
+   int lo = 0;
+   int remaining = n;
+   do {
+      int runLen = countRunAndMakeAscending(array, lo, n, compare);
+      // short runs are extended to minRun items with an insertion sort
+      if (runLen < minRun) {
+         int force = remaining <= minRun ? remaining : minRun;
+         binaryInsertionSort(array, lo, lo + force, lo + runLen, compare);
+         runLen = force;
+      }
+      assert(ms.runs < VECTOR_MAX_RUNS);
+      ms.runBase[ms.runs] = lo;
+      ms.runLen[ms.runs] = runLen;
+      ms.runs++;
+      mergeCollapse(&ms);
+      lo += runLen;
+      remaining -= runLen;
+   } while (remaining != 0);
+   mergeForceCollapse(&ms);
+   assert(ms.runs == 1 && ms.runLen[0] == n);
+   free(ms.tmp);
+}
+
+/*
+ * Stable sort by the class's compare function. Ascending and strictly
+ * descending runs already present are detected and merged, so an almost
+ * sorted vector (such as the process list from the previous refresh) is
+ * sorted in close to linear time, and the worst case is O(n log n).
+ */
+void Vector_sort(Vector* this) {
    assert(this->type->compare);
    assert(Vector_isConsistent(this));
-   quickSort(this->array, 0, this->items - 1, this->type->compare);
+   timSort(this->array, this->items, this->type->compare);
    assert(Vector_isConsistent(this));
 }
 
-void Vector_insertionSort(Vector* this) {
-   assert(this->type->compare);
+typedef struct VectorHeapItem_ {
+   Object* item;
+   int index;
+} VectorHeapItem;
+
+static inline bool VectorHeapItem_less(VectorHeapItem* a, VectorHeapItem* b, Object_Compare compare) {
+   // equal items keep their previous order
+   long cmp = compareCounted(compare, a->item, b->item);
+   return cmp < 0 || (cmp == 0 && a->index < b->index);
+}
+
+static void VectorHeapItem_siftDown(VectorHeapItem* heap, int i, int n, Object_Compare compare) {
+   VectorHeapItem top = heap[i];
+   for (;;) {
+      int child = 2 * i + 1;
+      if (child >= n)
+         break;
+      if (child + 1 < n && VectorHeapItem_less(&heap[child], &heap[child + 1], compare))
+         child++;
+      if (!VectorHeapItem_less(&top, &heap[child], compare))
+         break;
+      heap[i] = heap[child];
+      i = child;
+   }
+   heap[i] = top;
+}
+
+/*
+ * Stable partial sort of the items from start on by the given compare
+ * function: the first k of them end up as a full sort would leave them,
+ * and the rest follow in their previous order, so a later
+ * Vector_partialSort(this, start + k, ...) finishes the job with the same
+ * result as a full sort.
+ */
+void Vector_partialSort(Vector* this, int start, int k, Object_Compare compare) {
+   assert(compare);
    assert(Vector_isConsistent(this));
-   insertionSort(this->array, 0, this->items - 1, this->type->compare);
+   assert(start >= 0 && start <= this->items);
+   Object** array = this->array + start;
+   int n = this->items - start;
+   if (k <= 0 || k * VECTOR_PARTIAL_RATIO > n) {
+      timSort(array, n, compare);
+      return;
+   }
+   VectorHeapItem* heap = xMalloc(k * sizeof(VectorHeapItem));
+   for (int i = 0; i < k; i++)
+      heap[i] = (VectorHeapItem) { .item = array[i], .index = i };
+   for (int i = k / 2 - 1; i >= 0; i--)
+      VectorHeapItem_siftDown(heap, i, k, compare);
+   for (int i = k; i < n; i++) {
+      // later items only win over the largest kept one when strictly smaller
+      if (compareCounted(compare, array[i], heap[0].item) < 0) {
+         heap[0] = (VectorHeapItem) { .item = array[i], .index = i };
+         VectorHeapItem_siftDown(heap, 0, k, compare);
+      }
+   }
+   bool* selected = xCalloc(n, sizeof(bool));
+   for (int i = 0; i < k; i++)
+      selected[heap[i].index] = true;
+   // move the others to the back, keeping their order
+   int dst = n;
+   for (int i = n - 1; i >= 0; i--) {
+      if (!selected[i])
+         array[--dst] = array[i];
+   }
+   assert(dst == k);
+   for (int i = k - 1; i >= 0; i--) {
+      array[i] = heap[0].item;
+      heap[0] = heap[i];
+      VectorHeapItem_siftDown(heap, 0, i, compare);
+   }
+   free(selected);
+   free(heap);
    assert(Vector_isConsistent(this));
 }
 
+#define VectorSortKey_digit(k_, d_) ((d_) < 4 ? ((k_)->tie >> ((d_) * 8)) & 0xff : ((k_)->key >> (((d_) - 4) * 8)) & 0xff)
+
+#define VectorSortKey_less(a_, b_) ((a_)->key < (b_)->key || ((a_)->key == (b_)->key && (a_)->tie < (b_)->tie))
+
+// Below this many items per selected one, a partial sort is not worth it.
+#define VECTOR_PARTIAL_RATIO 8
+
+static VectorSortKey* radixSort(VectorSortKey* keys, VectorSortKey* tmp, int n) {
+   // least significant digit first, so each pass is stable;
+   // returns whichever of the two buffers ends up sorted
+   int (*counts)[256] = xCalloc(12, sizeof(*counts));
+   for (int i = 0; i < n; i++) {
+      for (int d = 0; d < 12; d++)
+         counts[d][VectorSortKey_digit(&keys[i], d)]++;
+   }
+   VectorSortKey* src = keys;
+   VectorSortKey* dst = tmp;
+   for (int d = 0; d < 12; d++) {
+      int* count = counts[d];
+      // a digit equal in all keys leaves the order as it is
+      if (count[VectorSortKey_digit(&src[0], d)] == n)
+         continue;
+      int offset = 0;
+      for (int b = 0; b < 256; b++) {
+         int c = count[b];
+         count[b] = offset;
+         offset += c;
+      }
+      for (int i = 0; i < n; i++)
+         dst[count[VectorSortKey_digit(&src[i], d)]++] = src[i];
+      VectorSortKey* t = src;
+      src = dst;
+      dst = t;
+   }
+   free(counts);
+   return src;
+}
+
+static void VectorSortKey_siftDown(VectorSortKey* heap, int i, int n) {
+   VectorSortKey top = heap[i];
+   for (;;) {
+      int child = 2 * i + 1;
+      if (child >= n)
+         break;
+      if (child + 1 < n && VectorSortKey_less(&heap[child], &heap[child + 1]))
+         child++;
+      if (!VectorSortKey_less(&top, &heap[child]))
+         break;
+      heap[i] = heap[child];
+      i = child;
+   }
+   heap[i] = top;
+}
+
+static void heapSelect(VectorSortKey* keys, int n, int k) {
+   // keeps the k smallest keys seen so far in a max-heap at the front,
+   // then sorts the heap in place
+   for (int i = k / 2 - 1; i >= 0; i--)
+      VectorSortKey_siftDown(keys, i, k);
+   for (int i = k; i < n; i++) {
+      if (VectorSortKey_less(&keys[i], &keys[0])) {
+         VectorSortKey t = keys[0];
+         keys[0] = keys[i];
+         keys[i] = t;
+         VectorSortKey_siftDown(keys, 0, k);
+      }
+   }
+   for (int i = k - 1; i > 0; i--) {
+      VectorSortKey t = keys[0];
+      keys[0] = keys[i];
+      keys[i] = t;
+      VectorSortKey_siftDown(keys, 0, i);
+   }
+}
+
+/*
+ * Reorders the items from start on as given by keys, one (key, tie) pair
+ * per item in any order, without calling the compare function. The first
+ * k of them end up in order and the rest follow in no particular order;
+ * pass the number of items to order them all. Keys are expected to be
+ * unique, so the result does not depend on the previous order.
+ */
+void Vector_partialSortByKeys(Vector* this, int start, VectorSortKey* keys, int k) {
+   assert(Vector_isConsistent(this));
+   assert(start >= 0 && start <= this->items);
+   int n = this->items - start;
+   if (n < 2) {
+      if (n == 1)
+         this->array[start] = keys[0].item;
+      return;
+   }
+   Object** array = this->array + start;
+   if (k > 0 && k * VECTOR_PARTIAL_RATIO <= n) {
+      heapSelect(keys, n, k);
+      for (int i = 0; i < n; i++)
+         array[i] = keys[i].item;
+   } else {
+      VectorSortKey* tmp = xMalloc(n * sizeof(VectorSortKey));
+      VectorSortKey* sorted = radixSort(keys, tmp, n);
+      for (int i = 0; i < n; i++)
+         array[i] = sorted[i].item;
+      free(tmp);
+   }
+   assert(Vector_isConsistent(this));
+}
+
+static void Vector_resize(Vector* this, int size) {
+   assert(size >= this->items);
+   Object** base = (Object**) xRealloc(this->array - this->head, sizeof(Object*) * (this->head + size));
+   this->array = base + this->head;
+   this->arraySize = size;
+}
+
 static void Vector_checkArraySize(Vector* this) {
    assert(Vector_isConsistent(this));
    if (this->items >= this->arraySize) {
-      //int i;
-      //i = this->arraySize;
-      this->arraySize = this->items + this->growthRate;
-      this->array = (Object**) xRealloc(this->array, sizeof(Object*) * this->arraySize);
-      //for (; i < this->arraySize; i++)
-      //   this->array[i] = NULL;
+      // geometric growth, so adding n items costs O(n) copies overall
+      int grow = MAX(this->arraySize, this->growthRate);
+      Vector_resize(this, this->items + grow);
+   }
+   assert(Vector_isConsistent(this));
+}
+
+void Vector_reserve(Vector* this, int size) {
+   assert(Vector_isConsistent(this));
+   if (size > this->arraySize)
+      Vector_resize(this, size);
+   assert(Vector_isConsistent(this));
+}
+
+void Vector_shrinkToFit(Vector* this) {
+   assert(Vector_isConsistent(this));
+   if (this->head > 0) {
+      Object** base = this->array - this->head;
+      memmove(base, this->array, this->items * sizeof(Object*));
+      this->array = base;
+      this->arraySize += this->head;
+      this->head = 0;
+   }
+   int size = MAX(this->items, 1);
+   if (size < this->arraySize)
+      Vector_resize(this, size);
+   assert(Vector_isConsistent(this));
+}
+
+/*
+ * Inserts at the front in constant amortized time: slots are kept free
+ * before the first item, and when they run out, as many as there are items
+ * are added.
+ */
+void Vector_prepend(Vector* this, void* data_) {
+   Object* data = data_;
+   assert(Object_isA(data, this->type));
+   assert(Vector_isConsistent(this));
+
+   if (this->head == 0) {
+      int head = MAX(this->items, this->growthRate);
+      int size = MAX(this->arraySize, this->items + 1);
+      Object** base = (Object**) xMalloc(sizeof(Object*) * (head + size));
+      memcpy(base + head, this->array, this->items * sizeof(Object*));
+      free(this->array);
+      this->array = base + head;
+      this->arraySize = size;
+      this->head = head;
    }
+   this->array--;
+   this->arraySize++;
+   this->head--;
+   this->array[0] = data;
+   this->items++;
    assert(Vector_isConsistent(this));
 }
 
@@ -192,6 +854,10 @@ void Vector_insert(Vector* this, int idx, void* data_) {
    assert(Object_isA(data, this->type));
    assert(Vector_isConsistent(this));
 
+   if (idx == 0) {
+      Vector_prepend(this, data);
+      return;
+   }
    if (idx > this->items) {
       idx = this->items;
    }
@@ -228,6 +894,29 @@ Object* Vector_remove(Vector* this, int idx) {
       return removed;
 }
 
+/*
+ * Removes, in a single pass, the items for which the predicate returns
+ * true, keeping the order of the others. The predicate is called once per
+ * item, in order. Returns how many items were removed.
+ */
+int Vector_removeIf(Vector* this, Vector_Predicate predicate, void* data) {
+   assert(Vector_isConsistent(this));
+   int dst = 0;
+   for (int i = 0; i < this->items; i++) {
+      Object* item = this->array[i];
+      if (predicate(item, data)) {
+         if (this->owner)
+            Object_delete(item);
+      } else {
+         this->array[dst++] = item;
+      }
+   }
+   int removed = this->items - dst;
+   this->items = dst;
+   assert(Vector_isConsistent(this));
+   return removed;
+}
+
 void Vector_moveUp(Vector* this, int idx) {
    assert(idx >= 0 && idx < this->items);
    assert(Vector_isConsistent(this));
@@ -322,6 +1011,16 @@ void Vector_add(Vector* this, void* data_) {
    assert(Vector_isConsistent(this));
 }
 
+void Vector_addAll(Vector* this, Object** data, int count) {
+   assert(count >= 0);
+   assert(Vector_isConsistent(this));
+   if (this->items + count > this->arraySize)
+      Vector_resize(this, MAX(this->items + count, this->arraySize + this->arraySize / 2));
+   memcpy(this->array + this->items, data, count * sizeof(Object*));
+   this->items += count;
+   assert(Vector_isConsistent(this));
+}
+
 inline int Vector_indexOf(Vector* this, void* search_, Object_Compare compare) {
    Object* search = search_;
    assert(Object_isA((Object*)search, this->type));
@@ -17,6 +17,10 @@ in the source distribution for its full text.
 #define DEFAULT_SIZE -1
 #endif
 
+#ifndef MAX
+#define MAX(a,b) ((a)>(b)?(a):(b))
+#endif
+
 typedef struct Vector_ {
    Object **array;
    ObjectClass* type;
@@ -24,8 +28,18 @@ typedef struct Vector_ {
    int growthRate;
    int items;
    bool owner;
+   // free slots allocated before array, used by Vector_prepend
+   int head;
 } Vector;
 
+typedef bool(*Vector_Predicate)(Object*, void*);
+
+typedef struct VectorSortKey_ {
+   unsigned long long key;
+   unsigned int tie;
+   Object* item;
+} VectorSortKey;
+
 
 Vector* Vector_new(ObjectClass* type, bool owner, int size);
 
@@ -46,7 +60,55 @@ void Vector_prune(Vector* this);
 
 void Vector_quickSort(Vector* this);
 
-void Vector_insertionSort(Vector* this);
+#define VECTOR_MIN_MERGE 32
+#define VECTOR_MIN_GALLOP 7
+#define VECTOR_MAX_RUNS 85
+
+
+/*
+ * Stable sort by the class's compare function. Ascending and strictly
+ * descending runs already present are detected and merged, so an almost
+ * sorted vector (such as the process list from the previous refresh) is
+ * sorted in close to linear time, and the worst case is O(n log n).
+ */
+void Vector_sort(Vector* this);
+
+
+/*
+ * Stable partial sort of the items from start on by the given compare
+ * function: the first k of them end up as a full sort would leave them,
+ * and the rest follow in their previous order, so a later
+ * Vector_partialSort(this, start + k, ...) finishes the job with the same
+ * result as a full sort.
+ */
+void Vector_partialSort(Vector* this, int start, int k, Object_Compare compare);
+
+#define VectorSortKey_digit(k_, d_) ((d_) < 4 ? ((k_)->tie >> ((d_) * 8)) & 0xff : ((k_)->key >> (((d_) - 4) * 8)) & 0xff)
+
+#define VectorSortKey_less(a_, b_) ((a_)->key < (b_)->key || ((a_)->key == (b_)->key && (a_)->tie < (b_)->tie))
+
+// Below this many items per selected one, a partial sort is not worth it.
+#define VECTOR_PARTIAL_RATIO 8
+
+/*
+ * Reorders the items from start on as given by keys, one (key, tie) pair
+ * per item in any order, without calling the compare function. The first
+ * k of them end up in order and the rest follow in no particular order;
+ * pass the number of items to order them all. Keys are expected to be
+ * unique, so the result does not depend on the previous order.
+ */
+void Vector_partialSortByKeys(Vector* this, int start, VectorSortKey* keys, int k);
+
+void Vector_reserve(Vector* this, int size);
+
+void Vector_shrinkToFit(Vector* this);
+
+/*
+ * Inserts at the front in constant amortized time: slots are kept free
+ * before the first item, and when they run out, as many as there are items
+ * are added.
+ */
+void Vector_prepend(Vector* this, void* data_);
 
 void Vector_insert(Vector* this, int idx, void* data_);
 
@@ -54,6 +116,13 @@ Object* Vector_take(Vector* this, int idx);
 
 Object* Vector_remove(Vector* this, int idx);
 
+/*
+ * Removes, in a single pass, the items for which the predicate returns
+ * true, keeping the order of the others. The predicate is called once per
+ * item, in order. Returns how many items were removed.
+ */
+int Vector_removeIf(Vector* this, Vector_Predicate predicate, void* data);
+
 void Vector_moveUp(Vector* this, int idx);
 
 void Vector_moveDown(Vector* this, int idx);
@@ -86,6 +155,8 @@ extern int Vector_size(Vector* this);
 
 void Vector_add(Vector* this, void* data_);
 
+void Vector_addAll(Vector* this, Object** data, int count);
+
 extern int Vector_indexOf(Vector* this, void* search_, Object_Compare compare);
 
 #endif
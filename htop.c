@@ -45,6 +45,7 @@ static void printHelpFlag() {
          "-t --tree                   Show the tree view by default\n"
          "-u --user=USERNAME          Show only processes of a given user\n"
          "-p --pid=PID,[,PID,PID...]  Show only the given PIDs\n"
+         "   --scan-threads=COUNT     Read process data using COUNT threads\n"
          "-v --version                Print version info\n"
          "\n"
          "Long options may be passed with a single dash.\n\n"
@@ -61,6 +62,7 @@ typedef struct CommandLineSettings_ {
    uid_t userId;
    int sortKey;
    int delay;
+   int scanThreads;
    bool useColors;
    bool treeView;
 } CommandLineSettings;
@@ -72,6 +74,7 @@ static CommandLineSettings parseArguments(int argc, char** argv) {
       .userId = -1, // -1 is guaranteed to be an invalid uid_t (see setreuid(2))
       .sortKey = 0,
       .delay = -1,
+      .scanThreads = -1,
       .useColors = true,
       .treeView = false,
    };
@@ -87,6 +90,7 @@ static CommandLineSettings parseArguments(int argc, char** argv) {
       {"no-colour",no_argument,         0, 'C'},
       {"tree",     no_argument,         0, 't'},
       {"pid",      required_argument,   0, 'p'},
+      {"scan-threads", required_argument, 0, 'T'},
       {0,0,0,0}
    };
 
@@ -122,6 +126,14 @@ static CommandLineSettings parseArguments(int argc, char** argv) {
                fprintf(stderr, "Error: invalid delay value \"%s\".\n", optarg);
             }
             break;
+         case 'T':
+            if (sscanf(optarg, "%16d", &(flags.scanThreads)) == 1) {
+               if (flags.scanThreads < 1) flags.scanThreads = 1;
+               if (flags.scanThreads > MAX_SCAN_THREADS) flags.scanThreads = MAX_SCAN_THREADS;
+            } else {
+               fprintf(stderr, "Error: invalid thread count \"%s\".\n", optarg);
+            }
+            break;
          case 'u':
             if (!Action_setUserOnly(optarg, &(flags.userId))) {
                fprintf(stderr, "Error: invalid user \"%s\".\n", optarg);
@@ -201,6 +213,8 @@ int main(int argc, char** argv) {
 
    if (flags.delay != -1)
       settings->delay = flags.delay;
+   if (flags.scanThreads != -1)
+      settings->scanThreads = flags.scanThreads;
    if (!flags.useColors) 
       settings->colorScheme = COLORSCHEME_MONOCHROME;
    if (flags.treeView)
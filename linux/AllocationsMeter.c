@@ -0,0 +1,66 @@
+/*
+htop - linux/AllocationsMeter.c
+(C) 2004-2011 Hisham H. Muhammad
+Released under the GNU GPL, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "AllocationsMeter.h"
+
+#include "LinuxProcessList.h"
+#include "CRT.h"
+
+/*{
+#include "Meter.h"
+}*/
+
+int AllocationsMeter_attributes[] = {
+   PROCESS, PROCESS_THREAD
+};
+
+static void AllocationsMeter_updateValues(Meter* this, char* buffer, int len) {
+   LinuxProcessList* lpl = (LinuxProcessList*) this->pl;
+   this->values[0] = lpl->allocTick.processes;
+   this->values[1] = lpl->allocTick.strings;
+   double sum = this->values[0] + this->values[1];
+   if (sum > this->total) {
+      this->total = sum;
+   }
+   xSnprintf(buffer, len, "%d/%d", (int) this->values[0], (int) this->values[1]);
+}
+
+static void AllocationsMeter_display(Object* cast, RichString* out) {
+   Meter* this = (Meter*)cast;
+   LinuxAllocCounters* tick = &((LinuxProcessList*) this->pl)->allocTick;
+   char buffer[64];
+
+   xSnprintf(buffer, sizeof(buffer), "%llu", tick->processes);
+   RichString_write(out, CRT_colors[METER_VALUE], buffer);
+   xSnprintf(buffer, sizeof(buffer), " new/%llu freed procs", tick->processFrees);
+   RichString_append(out, CRT_colors[METER_TEXT], buffer);
+   if (tick->processChunks) {
+      xSnprintf(buffer, sizeof(buffer), " (%llu chunks)", tick->processChunks);
+      RichString_append(out, CRT_colors[METER_TEXT], buffer);
+   }
+   RichString_append(out, CRT_colors[METER_TEXT], ", ");
+   xSnprintf(buffer, sizeof(buffer), "%llu", tick->strings);
+   RichString_append(out, CRT_colors[METER_VALUE], buffer);
+   xSnprintf(buffer, sizeof(buffer), " new/%llu shared/%llu freed strings", tick->stringsShared, tick->stringsReclaimed);
+   RichString_append(out, CRT_colors[METER_TEXT], buffer);
+}
+
+MeterClass AllocationsMeter_class = {
+   .super = {
+      .extends = Class(Meter),
+      .delete = Meter_delete,
+      .display = AllocationsMeter_display,
+   },
+   .updateValues = AllocationsMeter_updateValues,
+   .defaultMode = TEXT_METERMODE,
+   .maxItems = 2,
+   .total = 1.0,
+   .attributes = AllocationsMeter_attributes,
+   .name = "Allocations",
+   .uiName = "Allocations (debug)",
+   .caption = "Allocs: "
+};
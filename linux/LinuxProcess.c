@@ -10,10 +10,12 @@ in the source distribution for its full text.
 #include "LinuxProcess.h"
 #include "Platform.h"
 #include "CRT.h"
+#include "StringUtils.h"
 
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <math.h>
 #include <sys/syscall.h>
 #include <time.h>
 
@@ -24,6 +26,13 @@ in the source distribution for its full text.
 #define PROCESS_FLAG_LINUX_VSERVER  0x0400
 #define PROCESS_FLAG_LINUX_CGROUP   0x0800
 #define PROCESS_FLAG_LINUX_OOM      0x1000
+#define PROCESS_FLAG_LINUX_DELAYACCT 0x2000
+
+// fields refreshed every slowRefreshPeriod scans only
+#define PROCESS_FLAG_LINUX_SLOW (PROCESS_FLAG_LINUX_IOPRIO | PROCESS_FLAG_LINUX_CGROUP | PROCESS_FLAG_LINUX_OOM)
+
+// fields collected only for processes in view, unless sorted by
+#define PROCESS_FLAG_LINUX_LAZY (PROCESS_FLAG_IO | PROCESS_FLAG_LINUX_SLOW | PROCESS_FLAG_LINUX_DELAYACCT)
 
 typedef enum UnsupportedProcessFields {
    FLAGS = 9,
@@ -92,34 +101,77 @@ typedef enum LinuxProcessFields {
 
 #include "IOPriority.h"
 
+#ifdef HAVE_TASKSTATS
+typedef struct LinuxProcessIO_ {
+   unsigned long long rchar;
+   unsigned long long wchar;
+   unsigned long long syscr;
+   unsigned long long syscw;
+   unsigned long long read_bytes;
+   unsigned long long write_bytes;
+   unsigned long long cancelled_write_bytes;
+   unsigned long long rate_read_time;
+   unsigned long long rate_write_time;
+   double rate_read_bps;
+   double rate_write_bps;
+} LinuxProcessIO;
+#endif
+
+#ifdef HAVE_DELAYACCT
+typedef struct LinuxProcessDelay_ {
+   unsigned long long int read_time;
+   unsigned long long cpu_total;
+   unsigned long long blkio_total;
+   unsigned long long swapin_total;
+   float cpu_percent;
+   float blkio_percent;
+   float swapin_percent;
+   // the round of LinuxProcessList_scanDelayAcctData it was last read in
+   unsigned int round;
+} LinuxProcessDelay;
+#endif
+
+// The fields updated on every scan come right after the Process hot block;
+// the ones only read for optional columns are at the end, and the larger
+// groups of them are allocated the first time they are read. Budget for
+// non-DEBUG LP64 builds: Process is 192 bytes (three cache lines), and
+// LinuxProcess 360, or 392 with every optional feature enabled.
 typedef struct LinuxProcess_ {
    Process super;
+   int procDirFd;
+   int statFd;
+   int statmFd;
+   // PROCESS_FLAG_* groups read at least once, and not read on the last scan
+   int collectedFlags;
+   int staleFlags;
    bool isKernelThread;
-   IOPriority ioPriority;
-   unsigned long int cminflt;
-   unsigned long int cmajflt;
+   // a hidden kernel thread left unread, so its times are not current
+   bool statSkipped;
    unsigned long long int utime;
    unsigned long long int stime;
    unsigned long long int cutime;
    unsigned long long int cstime;
+   unsigned long long starttime;
+   unsigned long int cminflt;
+   unsigned long int cmajflt;
    long m_share;
    long m_trs;
    long m_drs;
    long m_lrs;
    long m_dt;
-   unsigned long long starttime;
-   #ifdef HAVE_TASKSTATS
-   unsigned long long io_rchar;
-   unsigned long long io_wchar;
-   unsigned long long io_syscr;
-   unsigned long long io_syscw;
-   unsigned long long io_read_bytes;
-   unsigned long long io_write_bytes;
-   unsigned long long io_cancelled_write_bytes;
-   unsigned long long io_rate_read_time;
-   unsigned long long io_rate_write_time;   
-   double io_rate_read_bps;
-   double io_rate_write_bps;
+   IOPriority ioPriority;
+   unsigned int oom;
+   // what stat said when cmdline was last read; exec changes them
+   unsigned int cmdlineCommHash;
+   // of the values read from stat and statm, to tell when they change
+   unsigned int statDigest;
+   unsigned long cmdlineStartCode;
+   unsigned long cmdlineEndCode;
+   // ttyDevice and super.comm are interned in LinuxProcess_strings,
+   // cgroup in LinuxProcess_cgroups
+   const char* ttyDevice;
+   #ifdef HAVE_CGROUP
+   const char* cgroup;
    #endif
    #ifdef HAVE_OPENVZ
    unsigned int ctid;
@@ -128,19 +180,11 @@ typedef struct LinuxProcess_ {
    #ifdef HAVE_VSERVER
    unsigned int vxid;
    #endif
-   #ifdef HAVE_CGROUP
-   char* cgroup;
+   #ifdef HAVE_TASKSTATS
+   LinuxProcessIO* io;
    #endif
-   unsigned int oom;
-   char* ttyDevice;
    #ifdef HAVE_DELAYACCT
-   unsigned long long int delay_read_time;
-   unsigned long long cpu_delay_total;
-   unsigned long long blkio_delay_total;
-   unsigned long long swapin_delay_total;
-   float cpu_delay_percent;
-   float blkio_delay_percent;
-   float swapin_delay_percent;
+   LinuxProcessDelay* delay;
    #endif
 } LinuxProcess;
 
@@ -152,33 +196,248 @@ typedef struct LinuxProcess_ {
 #define Process_isUserlandThread(_process) (_process->pid != _process->tgid)
 #endif
 
+#include "Slab.h"
+#include "StringPool.h"
+
 }*/
 
 long long btime; /* semi-global */
 
+/* descriptors of /proc/<pid> and its files kept open, across all processes */
+int LinuxProcess_keptFds = 0;
+
+/* where LinuxProcess objects, and their comm, ttyDevice and cgroup strings, come from */
+Slab* LinuxProcess_slab = NULL;
+StringPool* LinuxProcess_strings = NULL;
+StringPool* LinuxProcess_cgroups = NULL;
+
+/*
+[1] Note that before kernel 2.6.26 a process that has not asked for
+an io priority formally uses "none" as scheduling class, but the
+io scheduler will treat such processes as if it were in the best
+effort class. The priority within the best effort class will  be
+dynamically  derived  from  the  cpu  nice level of the process:
+io_priority = (cpu_nice + 20) / 5. -- From ionice(1) man page
+*/
+#define LinuxProcess_effectiveIOPriority(p_) (IOPriority_class(p_->ioPriority) == IOPRIO_CLASS_NONE ? IOPriority_tuple(IOPRIO_CLASS_BE, (p_->super.nice + 20) / 5) : p_->ioPriority)
+
+#ifdef HAVE_TASKSTATS
+static inline const LinuxProcessIO* LinuxProcess_io(const LinuxProcess* this) {
+   // reads as zeros until /proc/<pid>/io is read
+   static const LinuxProcessIO none;
+   return this->io ? this->io : &none;
+}
+
+#endif
+#ifdef HAVE_DELAYACCT
+static inline const LinuxProcessDelay* LinuxProcess_delay(const LinuxProcess* this) {
+   static const LinuxProcessDelay none;
+   return this->delay ? this->delay : &none;
+}
+
+#endif
+#ifdef HAVE_CGROUP
+static inline int LinuxProcess_cgroupRank(const LinuxProcess* this) {
+   // cgroups compare as their ranks, updated after every scan
+   return this->cgroup ? StringPool_rank(this->cgroup) : 0;
+}
+
+#endif
+static Process_comparator(LinuxProcess_compareDrs, LinuxProcess) {
+   return Process_compareNumbers(p2->m_drs, p1->m_drs);
+}
+
+static Process_comparator(LinuxProcess_compareDt, LinuxProcess) {
+   return Process_compareNumbers(p2->m_dt, p1->m_dt);
+}
+
+static Process_comparator(LinuxProcess_compareLrs, LinuxProcess) {
+   return Process_compareNumbers(p2->m_lrs, p1->m_lrs);
+}
+
+static Process_comparator(LinuxProcess_compareTrs, LinuxProcess) {
+   return Process_compareNumbers(p2->m_trs, p1->m_trs);
+}
+
+static Process_comparator(LinuxProcess_compareShare, LinuxProcess) {
+   return Process_compareNumbers(p2->m_share, p1->m_share);
+}
+
+static Process_comparator(LinuxProcess_compareUtime, LinuxProcess) {
+   return Process_compareNumbers(p2->utime, p1->utime);
+}
+
+static Process_comparator(LinuxProcess_compareCutime, LinuxProcess) {
+   return Process_compareNumbers(p2->cutime, p1->cutime);
+}
+
+static Process_comparator(LinuxProcess_compareStime, LinuxProcess) {
+   return Process_compareNumbers(p2->stime, p1->stime);
+}
+
+static Process_comparator(LinuxProcess_compareCstime, LinuxProcess) {
+   return Process_compareNumbers(p2->cstime, p1->cstime);
+}
+
+static Process_comparator(LinuxProcess_compareStartTime, LinuxProcess) {
+   if (p1->starttime == p2->starttime)
+      return Process_compareNumbers(p1->super.pid, p2->super.pid);
+   return Process_compareNumbers(p1->starttime, p2->starttime);
+}
+
+#ifdef HAVE_TASKSTATS
+static Process_comparator(LinuxProcess_compareRchar, LinuxProcess) {
+   return Process_compareNumbers(LinuxProcess_io(p2)->rchar, LinuxProcess_io(p1)->rchar);
+}
+
+static Process_comparator(LinuxProcess_compareWchar, LinuxProcess) {
+   return Process_compareNumbers(LinuxProcess_io(p2)->wchar, LinuxProcess_io(p1)->wchar);
+}
+
+static Process_comparator(LinuxProcess_compareSyscr, LinuxProcess) {
+   return Process_compareNumbers(LinuxProcess_io(p2)->syscr, LinuxProcess_io(p1)->syscr);
+}
+
+static Process_comparator(LinuxProcess_compareSyscw, LinuxProcess) {
+   return Process_compareNumbers(LinuxProcess_io(p2)->syscw, LinuxProcess_io(p1)->syscw);
+}
+
+static Process_comparator(LinuxProcess_compareRbytes, LinuxProcess) {
+   return Process_compareNumbers(LinuxProcess_io(p2)->read_bytes, LinuxProcess_io(p1)->read_bytes);
+}
+
+static Process_comparator(LinuxProcess_compareWbytes, LinuxProcess) {
+   return Process_compareNumbers(LinuxProcess_io(p2)->write_bytes, LinuxProcess_io(p1)->write_bytes);
+}
+
+static Process_comparator(LinuxProcess_compareCnclwb, LinuxProcess) {
+   return Process_compareNumbers(LinuxProcess_io(p2)->cancelled_write_bytes, LinuxProcess_io(p1)->cancelled_write_bytes);
+}
+
+static Process_comparator(LinuxProcess_compareIoReadRate, LinuxProcess) {
+   return Process_compareNumbers(LinuxProcess_io(p2)->rate_read_bps, LinuxProcess_io(p1)->rate_read_bps);
+}
+
+static Process_comparator(LinuxProcess_compareIoWriteRate, LinuxProcess) {
+   return Process_compareNumbers(LinuxProcess_io(p2)->rate_write_bps, LinuxProcess_io(p1)->rate_write_bps);
+}
+
+static Process_comparator(LinuxProcess_compareIoRate, LinuxProcess) {
+   const LinuxProcessIO* io1 = LinuxProcess_io(p1);
+   const LinuxProcessIO* io2 = LinuxProcess_io(p2);
+   return Process_compareNumbers(io2->rate_read_bps + io2->rate_write_bps, io1->rate_read_bps + io1->rate_write_bps);
+}
+
+#endif
+#ifdef HAVE_OPENVZ
+static Process_comparator(LinuxProcess_compareCtid, LinuxProcess) {
+   return Process_compareNumbers(p2->ctid, p1->ctid);
+}
+
+static Process_comparator(LinuxProcess_compareVpid, LinuxProcess) {
+   return Process_compareNumbers(p2->vpid, p1->vpid);
+}
+
+#endif
+#ifdef HAVE_VSERVER
+static Process_comparator(LinuxProcess_compareVxid, LinuxProcess) {
+   return Process_compareNumbers(p2->vxid, p1->vxid);
+}
+
+#endif
+#ifdef HAVE_CGROUP
+static Process_comparator(LinuxProcess_compareCgroup, LinuxProcess) {
+   return Process_compareNumbers(LinuxProcess_cgroupRank(p1), LinuxProcess_cgroupRank(p2));
+}
+
+#endif
+static Process_comparator(LinuxProcess_compareOom, LinuxProcess) {
+   return Process_compareNumbers(p2->oom, p1->oom);
+}
+
+#ifdef HAVE_DELAYACCT
+static Process_comparator(LinuxProcess_compareCpuDelay, LinuxProcess) {
+   return Process_compareNumbers(LinuxProcess_delay(p2)->cpu_percent, LinuxProcess_delay(p1)->cpu_percent);
+}
+
+static Process_comparator(LinuxProcess_compareIoDelay, LinuxProcess) {
+   return Process_compareNumbers(LinuxProcess_delay(p2)->blkio_percent, LinuxProcess_delay(p1)->blkio_percent);
+}
+
+static Process_comparator(LinuxProcess_compareSwapDelay, LinuxProcess) {
+   return Process_compareNumbers(LinuxProcess_delay(p2)->swapin_percent, LinuxProcess_delay(p1)->swapin_percent);
+}
+
+#endif
+static Process_comparator(LinuxProcess_compareIOPriority, LinuxProcess) {
+   return LinuxProcess_effectiveIOPriority(p1) - LinuxProcess_effectiveIOPriority(p2);
+}
+
+static const Object_Compare LinuxProcess_compareBy[][2] = {
+   [M_DRS] = Process_comparators(LinuxProcess_compareDrs),
+   [M_DT] = Process_comparators(LinuxProcess_compareDt),
+   [M_LRS] = Process_comparators(LinuxProcess_compareLrs),
+   [M_TRS] = Process_comparators(LinuxProcess_compareTrs),
+   [M_SHARE] = Process_comparators(LinuxProcess_compareShare),
+   [UTIME] = Process_comparators(LinuxProcess_compareUtime),
+   [CUTIME] = Process_comparators(LinuxProcess_compareCutime),
+   [STIME] = Process_comparators(LinuxProcess_compareStime),
+   [CSTIME] = Process_comparators(LinuxProcess_compareCstime),
+   [STARTTIME] = Process_comparators(LinuxProcess_compareStartTime),
+#ifdef HAVE_TASKSTATS
+   [RCHAR] = Process_comparators(LinuxProcess_compareRchar),
+   [WCHAR] = Process_comparators(LinuxProcess_compareWchar),
+   [SYSCR] = Process_comparators(LinuxProcess_compareSyscr),
+   [SYSCW] = Process_comparators(LinuxProcess_compareSyscw),
+   [RBYTES] = Process_comparators(LinuxProcess_compareRbytes),
+   [WBYTES] = Process_comparators(LinuxProcess_compareWbytes),
+   [CNCLWB] = Process_comparators(LinuxProcess_compareCnclwb),
+   [IO_READ_RATE] = Process_comparators(LinuxProcess_compareIoReadRate),
+   [IO_WRITE_RATE] = Process_comparators(LinuxProcess_compareIoWriteRate),
+   [IO_RATE] = Process_comparators(LinuxProcess_compareIoRate),
+#endif
+#ifdef HAVE_OPENVZ
+   [CTID] = Process_comparators(LinuxProcess_compareCtid),
+   [VPID] = Process_comparators(LinuxProcess_compareVpid),
+#endif
+#ifdef HAVE_VSERVER
+   [VXID] = Process_comparators(LinuxProcess_compareVxid),
+#endif
+#ifdef HAVE_CGROUP
+   [CGROUP] = Process_comparators(LinuxProcess_compareCgroup),
+#endif
+   [OOM] = Process_comparators(LinuxProcess_compareOom),
+#ifdef HAVE_DELAYACCT
+   [PERCENT_CPU_DELAY] = Process_comparators(LinuxProcess_compareCpuDelay),
+   [PERCENT_IO_DELAY] = Process_comparators(LinuxProcess_compareIoDelay),
+   [PERCENT_SWAP_DELAY] = Process_comparators(LinuxProcess_compareSwapDelay),
+#endif
+   [IO_PRIORITY] = Process_comparators(LinuxProcess_compareIOPriority),
+};
+
 ProcessFieldData Process_fields[] = {
    [0] = { .name = "", .title = NULL, .description = NULL, .flags = 0, },
-   [PID] = { .name = "PID", .title = "    PID ", .description = "Process/thread ID", .flags = 0, },
-   [COMM] = { .name = "Command", .title = "Command ", .description = "Command line", .flags = 0, },
-   [STATE] = { .name = "STATE", .title = "S ", .description = "Process state (S sleeping, R running, D disk, Z zombie, T traced, W paging, I idle)", .flags = 0, },
-   [PPID] = { .name = "PPID", .title = "   PPID ", .description = "Parent process ID", .flags = 0, },
-   [PGRP] = { .name = "PGRP", .title = "   PGRP ", .description = "Process group ID", .flags = 0, },
-   [SESSION] = { .name = "SESSION", .title = "    SID ", .description = "Process's session ID", .flags = 0, },
-   [TTY_NR] = { .name = "TTY_NR", .title = "TTY      ", .description = "Controlling terminal", .flags = 0, },
-   [TPGID] = { .name = "TPGID", .title = "  TPGID ", .description = "Process ID of the fg process group of the controlling terminal", .flags = 0, },
+   [PID] = { .name = "PID", .title = "    PID ", .description = "Process/thread ID", .flags = 0, .compare = Process_compareBy[PID], },
+   [COMM] = { .name = "Command", .title = "Command ", .description = "Command line", .flags = 0, .compare = Process_compareBy[COMM], },
+   [STATE] = { .name = "STATE", .title = "S ", .description = "Process state (S sleeping, R running, D disk, Z zombie, T traced, W paging, I idle)", .flags = 0, .compare = Process_compareBy[STATE], },
+   [PPID] = { .name = "PPID", .title = "   PPID ", .description = "Parent process ID", .flags = 0, .compare = Process_compareBy[PPID], },
+   [PGRP] = { .name = "PGRP", .title = "   PGRP ", .description = "Process group ID", .flags = 0, .compare = Process_compareBy[PGRP], },
+   [SESSION] = { .name = "SESSION", .title = "    SID ", .description = "Process's session ID", .flags = 0, .compare = Process_compareBy[SESSION], },
+   [TTY_NR] = { .name = "TTY_NR", .title = "TTY      ", .description = "Controlling terminal", .flags = 0, .compare = Process_compareBy[TTY_NR], },
+   [TPGID] = { .name = "TPGID", .title = "  TPGID ", .description = "Process ID of the fg process group of the controlling terminal", .flags = 0, .compare = Process_compareBy[TPGID], },
    [FLAGS] = { .name = "FLAGS", .title = NULL, .description = NULL, .flags = 0, },
-   [MINFLT] = { .name = "MINFLT", .title = "     MINFLT ", .description = "Number of minor faults which have not required loading a memory page from disk", .flags = 0, },
+   [MINFLT] = { .name = "MINFLT", .title = "     MINFLT ", .description = "Number of minor faults which have not required loading a memory page from disk", .flags = 0, .compare = Process_compareBy[MINFLT], },
    [CMINFLT] = { .name = "CMINFLT", .title = "    CMINFLT ", .description = "Children processes' minor faults", .flags = 0, },
-   [MAJFLT] = { .name = "MAJFLT", .title = "     MAJFLT ", .description = "Number of major faults which have required loading a memory page from disk", .flags = 0, },
+   [MAJFLT] = { .name = "MAJFLT", .title = "     MAJFLT ", .description = "Number of major faults which have required loading a memory page from disk", .flags = 0, .compare = Process_compareBy[MAJFLT], },
    [CMAJFLT] = { .name = "CMAJFLT", .title = "    CMAJFLT ", .description = "Children processes' major faults", .flags = 0, },
-   [UTIME] = { .name = "UTIME", .title = " UTIME+  ", .description = "User CPU time - time the process spent executing in user mode", .flags = 0, },
-   [STIME] = { .name = "STIME", .title = " STIME+  ", .description = "System CPU time - time the kernel spent running system calls for this process", .flags = 0, },
-   [CUTIME] = { .name = "CUTIME", .title = " CUTIME+ ", .description = "Children processes' user CPU time", .flags = 0, },
-   [CSTIME] = { .name = "CSTIME", .title = " CSTIME+ ", .description = "Children processes' system CPU time", .flags = 0, },
-   [PRIORITY] = { .name = "PRIORITY", .title = "PRI ", .description = "Kernel's internal priority for the process", .flags = 0, },
-   [NICE] = { .name = "NICE", .title = " NI ", .description = "Nice value (the higher the value, the more it lets other processes take priority)", .flags = 0, },
+   [UTIME] = { .name = "UTIME", .title = " UTIME+  ", .description = "User CPU time - time the process spent executing in user mode", .flags = 0, .compare = LinuxProcess_compareBy[UTIME], },
+   [STIME] = { .name = "STIME", .title = " STIME+  ", .description = "System CPU time - time the kernel spent running system calls for this process", .flags = 0, .compare = LinuxProcess_compareBy[STIME], },
+   [CUTIME] = { .name = "CUTIME", .title = " CUTIME+ ", .description = "Children processes' user CPU time", .flags = 0, .compare = LinuxProcess_compareBy[CUTIME], },
+   [CSTIME] = { .name = "CSTIME", .title = " CSTIME+ ", .description = "Children processes' system CPU time", .flags = 0, .compare = LinuxProcess_compareBy[CSTIME], },
+   [PRIORITY] = { .name = "PRIORITY", .title = "PRI ", .description = "Kernel's internal priority for the process", .flags = 0, .compare = Process_compareBy[PRIORITY], },
+   [NICE] = { .name = "NICE", .title = " NI ", .description = "Nice value (the higher the value, the more it lets other processes take priority)", .flags = 0, .compare = Process_compareBy[NICE], },
    [ITREALVALUE] = { .name = "ITREALVALUE", .title = NULL, .description = NULL, .flags = 0, },
-   [STARTTIME] = { .name = "STARTTIME", .title = "START ", .description = "Time the process was started", .flags = 0, },
+   [STARTTIME] = { .name = "STARTTIME", .title = "START ", .description = "Time the process was started", .flags = 0, .compare = LinuxProcess_compareBy[STARTTIME], },
    [VSIZE] = { .name = "VSIZE", .title = NULL, .description = NULL, .flags = 0, },
    [RSS] = { .name = "RSS", .title = NULL, .description = NULL, .flags = 0, },
    [RLIM] = { .name = "RLIM", .title = NULL, .description = NULL, .flags = 0, },
@@ -195,49 +454,49 @@ ProcessFieldData Process_fields[] = {
    [NSWAP] = { .name = "NSWAP", .title = NULL, .description = NULL, .flags = 0, },
    [CNSWAP] = { .name = "CNSWAP", .title = NULL, .description = NULL, .flags = 0, },
    [EXIT_SIGNAL] = { .name = "EXIT_SIGNAL", .title = NULL, .description = NULL, .flags = 0, },
-   [PROCESSOR] = { .name = "PROCESSOR", .title = "CPU ", .description = "Id of the CPU the process last executed on", .flags = 0, },
-   [M_SIZE] = { .name = "M_SIZE", .title = " VIRT ", .description = "Total program size in virtual memory", .flags = 0, },
-   [M_RESIDENT] = { .name = "M_RESIDENT", .title = "  RES ", .description = "Resident set size, size of the text and data sections, plus stack usage", .flags = 0, },
-   [M_SHARE] = { .name = "M_SHARE", .title = "  SHR ", .description = "Size of the process's shared pages", .flags = 0, },
-   [M_TRS] = { .name = "M_TRS", .title = " CODE ", .description = "Size of the text segment of the process", .flags = 0, },
-   [M_DRS] = { .name = "M_DRS", .title = " DATA ", .description = "Size of the data segment plus stack usage of the process", .flags = 0, },
-   [M_LRS] = { .name = "M_LRS", .title = " LIB ", .description = "The library size of the process", .flags = 0, },
-   [M_DT] = { .name = "M_DT", .title = " DIRTY ", .description = "Size of the dirty pages of the process", .flags = 0, },
-   [ST_UID] = { .name = "ST_UID", .title = " UID ", .description = "User ID of the process owner", .flags = 0, },
-   [PERCENT_CPU] = { .name = "PERCENT_CPU", .title = "CPU% ", .description = "Percentage of the CPU time the process used in the last sampling", .flags = 0, },
-   [PERCENT_MEM] = { .name = "PERCENT_MEM", .title = "MEM% ", .description = "Percentage of the memory the process is using, based on resident memory size", .flags = 0, },
-   [USER] = { .name = "USER", .title = "USER      ", .description = "Username of the process owner (or user ID if name cannot be determined)", .flags = 0, },
-   [TIME] = { .name = "TIME", .title = "  TIME+  ", .description = "Total time the process has spent in user and system time", .flags = 0, },
-   [NLWP] = { .name = "NLWP", .title = "NLWP ", .description = "Number of threads in the process", .flags = 0, },
-   [TGID] = { .name = "TGID", .title = "   TGID ", .description = "Thread group ID (i.e. process ID)", .flags = 0, },
+   [PROCESSOR] = { .name = "PROCESSOR", .title = "CPU ", .description = "Id of the CPU the process last executed on", .flags = 0, .compare = Process_compareBy[PROCESSOR], },
+   [M_SIZE] = { .name = "M_SIZE", .title = " VIRT ", .description = "Total program size in virtual memory", .flags = 0, .compare = Process_compareBy[M_SIZE], },
+   [M_RESIDENT] = { .name = "M_RESIDENT", .title = "  RES ", .description = "Resident set size, size of the text and data sections, plus stack usage", .flags = 0, .compare = Process_compareBy[M_RESIDENT], },
+   [M_SHARE] = { .name = "M_SHARE", .title = "  SHR ", .description = "Size of the process's shared pages", .flags = 0, .compare = LinuxProcess_compareBy[M_SHARE], },
+   [M_TRS] = { .name = "M_TRS", .title = " CODE ", .description = "Size of the text segment of the process", .flags = 0, .compare = LinuxProcess_compareBy[M_TRS], },
+   [M_DRS] = { .name = "M_DRS", .title = " DATA ", .description = "Size of the data segment plus stack usage of the process", .flags = 0, .compare = LinuxProcess_compareBy[M_DRS], },
+   [M_LRS] = { .name = "M_LRS", .title = " LIB ", .description = "The library size of the process", .flags = 0, .compare = LinuxProcess_compareBy[M_LRS], },
+   [M_DT] = { .name = "M_DT", .title = " DIRTY ", .description = "Size of the dirty pages of the process", .flags = 0, .compare = LinuxProcess_compareBy[M_DT], },
+   [ST_UID] = { .name = "ST_UID", .title = " UID ", .description = "User ID of the process owner", .flags = 0, .compare = Process_compareBy[ST_UID], },
+   [PERCENT_CPU] = { .name = "PERCENT_CPU", .title = "CPU% ", .description = "Percentage of the CPU time the process used in the last sampling", .flags = 0, .compare = Process_compareBy[PERCENT_CPU], },
+   [PERCENT_MEM] = { .name = "PERCENT_MEM", .title = "MEM% ", .description = "Percentage of the memory the process is using, based on resident memory size", .flags = 0, .compare = Process_compareBy[PERCENT_MEM], },
+   [USER] = { .name = "USER", .title = "USER      ", .description = "Username of the process owner (or user ID if name cannot be determined)", .flags = 0, .compare = Process_compareBy[USER], },
+   [TIME] = { .name = "TIME", .title = "  TIME+  ", .description = "Total time the process has spent in user and system time", .flags = 0, .compare = Process_compareBy[TIME], },
+   [NLWP] = { .name = "NLWP", .title = "NLWP ", .description = "Number of threads in the process", .flags = 0, .compare = Process_compareBy[NLWP], },
+   [TGID] = { .name = "TGID", .title = "   TGID ", .description = "Thread group ID (i.e. process ID)", .flags = 0, .compare = Process_compareBy[TGID], },
 #ifdef HAVE_OPENVZ
-   [CTID] = { .name = "CTID", .title = "   CTID ", .description = "OpenVZ container ID (a.k.a. virtual environment ID)", .flags = PROCESS_FLAG_LINUX_OPENVZ, },
-   [VPID] = { .name = "VPID", .title = " VPID ", .description = "OpenVZ process ID", .flags = PROCESS_FLAG_LINUX_OPENVZ, },
+   [CTID] = { .name = "CTID", .title = "   CTID ", .description = "OpenVZ container ID (a.k.a. virtual environment ID)", .flags = PROCESS_FLAG_LINUX_OPENVZ, .compare = LinuxProcess_compareBy[CTID], },
+   [VPID] = { .name = "VPID", .title = " VPID ", .description = "OpenVZ process ID", .flags = PROCESS_FLAG_LINUX_OPENVZ, .compare = LinuxProcess_compareBy[VPID], },
 #endif
 #ifdef HAVE_VSERVER
-   [VXID] = { .name = "VXID", .title = " VXID ", .description = "VServer process ID", .flags = PROCESS_FLAG_LINUX_VSERVER, },
+   [VXID] = { .name = "VXID", .title = " VXID ", .description = "VServer process ID", .flags = PROCESS_FLAG_LINUX_VSERVER, .compare = LinuxProcess_compareBy[VXID], },
 #endif
 #ifdef HAVE_TASKSTATS
-   [RCHAR] = { .name = "RCHAR", .title = "    RD_CHAR ", .description = "Number of bytes the process has read", .flags = PROCESS_FLAG_IO, },
-   [WCHAR] = { .name = "WCHAR", .title = "    WR_CHAR ", .description = "Number of bytes the process has written", .flags = PROCESS_FLAG_IO, },
-   [SYSCR] = { .name = "SYSCR", .title = "    RD_SYSC ", .description = "Number of read(2) syscalls for the process", .flags = PROCESS_FLAG_IO, },
-   [SYSCW] = { .name = "SYSCW", .title = "    WR_SYSC ", .description = "Number of write(2) syscalls for the process", .flags = PROCESS_FLAG_IO, },
-   [RBYTES] = { .name = "RBYTES", .title = "  IO_RBYTES ", .description = "Bytes of read(2) I/O for the process", .flags = PROCESS_FLAG_IO, },
-   [WBYTES] = { .name = "WBYTES", .title = "  IO_WBYTES ", .description = "Bytes of write(2) I/O for the process", .flags = PROCESS_FLAG_IO, },
-   [CNCLWB] = { .name = "CNCLWB", .title = "  IO_CANCEL ", .description = "Bytes of cancelled write(2) I/O", .flags = PROCESS_FLAG_IO, },
-   [IO_READ_RATE] = { .name = "IO_READ_RATE", .title = "  DISK READ ", .description = "The I/O rate of read(2) in bytes per second for the process", .flags = PROCESS_FLAG_IO, },
-   [IO_WRITE_RATE] = { .name = "IO_WRITE_RATE", .title = " DISK WRITE ", .description = "The I/O rate of write(2) in bytes per second for the process", .flags = PROCESS_FLAG_IO, },
-   [IO_RATE] = { .name = "IO_RATE", .title = "   DISK R/W ", .description = "Total I/O rate in bytes per second", .flags = PROCESS_FLAG_IO, },
+   [RCHAR] = { .name = "RCHAR", .title = "    RD_CHAR ", .description = "Number of bytes the process has read", .flags = PROCESS_FLAG_IO, .compare = LinuxProcess_compareBy[RCHAR], },
+   [WCHAR] = { .name = "WCHAR", .title = "    WR_CHAR ", .description = "Number of bytes the process has written", .flags = PROCESS_FLAG_IO, .compare = LinuxProcess_compareBy[WCHAR], },
+   [SYSCR] = { .name = "SYSCR", .title = "    RD_SYSC ", .description = "Number of read(2) syscalls for the process", .flags = PROCESS_FLAG_IO, .compare = LinuxProcess_compareBy[SYSCR], },
+   [SYSCW] = { .name = "SYSCW", .title = "    WR_SYSC ", .description = "Number of write(2) syscalls for the process", .flags = PROCESS_FLAG_IO, .compare = LinuxProcess_compareBy[SYSCW], },
+   [RBYTES] = { .name = "RBYTES", .title = "  IO_RBYTES ", .description = "Bytes of read(2) I/O for the process", .flags = PROCESS_FLAG_IO, .compare = LinuxProcess_compareBy[RBYTES], },
+   [WBYTES] = { .name = "WBYTES", .title = "  IO_WBYTES ", .description = "Bytes of write(2) I/O for the process", .flags = PROCESS_FLAG_IO, .compare = LinuxProcess_compareBy[WBYTES], },
+   [CNCLWB] = { .name = "CNCLWB", .title = "  IO_CANCEL ", .description = "Bytes of cancelled write(2) I/O", .flags = PROCESS_FLAG_IO, .compare = LinuxProcess_compareBy[CNCLWB], },
+   [IO_READ_RATE] = { .name = "IO_READ_RATE", .title = "  DISK READ ", .description = "The I/O rate of read(2) in bytes per second for the process", .flags = PROCESS_FLAG_IO, .compare = LinuxProcess_compareBy[IO_READ_RATE], },
+   [IO_WRITE_RATE] = { .name = "IO_WRITE_RATE", .title = " DISK WRITE ", .description = "The I/O rate of write(2) in bytes per second for the process", .flags = PROCESS_FLAG_IO, .compare = LinuxProcess_compareBy[IO_WRITE_RATE], },
+   [IO_RATE] = { .name = "IO_RATE", .title = "   DISK R/W ", .description = "Total I/O rate in bytes per second", .flags = PROCESS_FLAG_IO, .compare = LinuxProcess_compareBy[IO_RATE], },
 #endif
 #ifdef HAVE_CGROUP
-   [CGROUP] = { .name = "CGROUP", .title = "    CGROUP ", .description = "Which cgroup the process is in", .flags = PROCESS_FLAG_LINUX_CGROUP, },
+   [CGROUP] = { .name = "CGROUP", .title = "    CGROUP ", .description = "Which cgroup the process is in", .flags = PROCESS_FLAG_LINUX_CGROUP, .compare = LinuxProcess_compareBy[CGROUP], },
 #endif
-   [OOM] = { .name = "OOM", .title = "    OOM ", .description = "OOM (Out-of-Memory) killer score", .flags = PROCESS_FLAG_LINUX_OOM, },
-   [IO_PRIORITY] = { .name = "IO_PRIORITY", .title = "IO ", .description = "I/O priority", .flags = PROCESS_FLAG_LINUX_IOPRIO, },
+   [OOM] = { .name = "OOM", .title = "    OOM ", .description = "OOM (Out-of-Memory) killer score", .flags = PROCESS_FLAG_LINUX_OOM, .compare = LinuxProcess_compareBy[OOM], },
+   [IO_PRIORITY] = { .name = "IO_PRIORITY", .title = "IO ", .description = "I/O priority", .flags = PROCESS_FLAG_LINUX_IOPRIO, .compare = LinuxProcess_compareBy[IO_PRIORITY], },
 #ifdef HAVE_DELAYACCT
-   [PERCENT_CPU_DELAY] = { .name = "PERCENT_CPU_DELAY", .title = "CPUD% ", .description = "CPU delay %", .flags = 0, },
-   [PERCENT_IO_DELAY] = { .name = "PERCENT_IO_DELAY", .title = "IOD% ", .description = "Block I/O delay %", .flags = 0, },
-   [PERCENT_SWAP_DELAY] = { .name = "PERCENT_SWAP_DELAY", .title = "SWAPD% ", .description = "Swapin delay %", .flags = 0, },
+   [PERCENT_CPU_DELAY] = { .name = "PERCENT_CPU_DELAY", .title = "CPUD% ", .description = "CPU delay %", .flags = PROCESS_FLAG_LINUX_DELAYACCT, .compare = LinuxProcess_compareBy[PERCENT_CPU_DELAY], },
+   [PERCENT_IO_DELAY] = { .name = "PERCENT_IO_DELAY", .title = "IOD% ", .description = "Block I/O delay %", .flags = PROCESS_FLAG_LINUX_DELAYACCT, .compare = LinuxProcess_compareBy[PERCENT_IO_DELAY], },
+   [PERCENT_SWAP_DELAY] = { .name = "PERCENT_SWAP_DELAY", .title = "SWAPD% ", .description = "Swapin delay %", .flags = PROCESS_FLAG_LINUX_DELAYACCT, .compare = LinuxProcess_compareBy[PERCENT_SWAP_DELAY], },
 #endif
    [LAST_PROCESSFIELD] = { .name = "*** report bug! ***", .title = NULL, .description = NULL, .flags = 0, },
 };
@@ -264,35 +523,52 @@ ProcessClass LinuxProcess_class = {
       .compare = LinuxProcess_compare
    },
    .writeField = (Process_WriteField) LinuxProcess_writeField,
+   .sortKey = (Process_SortKey) LinuxProcess_sortKey,
 };
 
 LinuxProcess* LinuxProcess_new(Settings* settings) {
-   LinuxProcess* this = xCalloc(1, sizeof(LinuxProcess));
+   LinuxProcess* this = Slab_alloc(LinuxProcess_slab);
    Object_setClass(this, Class(LinuxProcess));
    Process_init(&this->super, settings);
+   this->procDirFd = -1;
+   this->statFd = -1;
+   this->statmFd = -1;
    return this;
 }
 
+void LinuxProcess_closeFile(int* fd) {
+   if (*fd != -1) {
+      close(*fd);
+      *fd = -1;
+      __sync_sub_and_fetch(&LinuxProcess_keptFds, 1);
+   }
+}
+
+void LinuxProcess_closeFiles(LinuxProcess* this) {
+   LinuxProcess_closeFile(&(this->statFd));
+   LinuxProcess_closeFile(&(this->statmFd));
+   LinuxProcess_closeFile(&(this->procDirFd));
+}
+
 void Process_delete(Object* cast) {
    LinuxProcess* this = (LinuxProcess*) cast;
+   StringPool_release(LinuxProcess_strings, this->super.comm);
+   this->super.comm = NULL;
    Process_done((Process*)cast);
+   LinuxProcess_closeFiles(this);
 #ifdef HAVE_CGROUP
-   free(this->cgroup);
+   StringPool_release(LinuxProcess_cgroups, this->cgroup);
+#endif
+   StringPool_release(LinuxProcess_strings, this->ttyDevice);
+#ifdef HAVE_TASKSTATS
+   free(this->io);
+#endif
+#ifdef HAVE_DELAYACCT
+   free(this->delay);
 #endif
-   free(this->ttyDevice);
-   free(this);
+   Slab_free(LinuxProcess_slab, this);
 }
 
-/*
-[1] Note that before kernel 2.6.26 a process that has not asked for
-an io priority formally uses "none" as scheduling class, but the
-io scheduler will treat such processes as if it were in the best
-effort class. The priority within the best effort class will  be
-dynamically  derived  from  the  cpu  nice level of the process:
-io_priority = (cpu_nice + 20) / 5. -- From ionice(1) man page
-*/
-#define LinuxProcess_effectiveIOPriority(p_) (IOPriority_class(p_->ioPriority) == IOPRIO_CLASS_NONE ? IOPriority_tuple(IOPRIO_CLASS_BE, (p_->super.nice + 20) / 5) : p_->ioPriority)
-
 IOPriority LinuxProcess_updateIOPriority(LinuxProcess* this) {
    IOPriority ioprio = 0;
 // Other OSes masquerading as Linux (NetBSD?) don't have this syscall
@@ -315,6 +591,9 @@ bool LinuxProcess_setIOPriority(LinuxProcess* this, IOPriority ioprio) {
 void LinuxProcess_printDelay(float delay_percent, char* buffer, int n) {
   if (delay_percent == -1LL) {
     xSnprintf(buffer, n, " N/A  ");
+  } else if (delay_percent >= 0) {
+    int len = String_formatFixed(buffer, lrint(delay_percent * 10.0), 1, 4);
+    strcpy(buffer + len, "  ");
   } else {
     xSnprintf(buffer, n, "%4.1f  ", delay_percent);
   }
@@ -356,33 +635,34 @@ void LinuxProcess_writeField(Process* this, RichString* str, ProcessField field)
      break;
    }
    #ifdef HAVE_TASKSTATS
-   case RCHAR:  Process_colorNumber(str, lp->io_rchar, coloring); return;
-   case WCHAR:  Process_colorNumber(str, lp->io_wchar, coloring); return;
-   case SYSCR:  Process_colorNumber(str, lp->io_syscr, coloring); return;
-   case SYSCW:  Process_colorNumber(str, lp->io_syscw, coloring); return;
-   case RBYTES: Process_colorNumber(str, lp->io_read_bytes, coloring); return;
-   case WBYTES: Process_colorNumber(str, lp->io_write_bytes, coloring); return;
-   case CNCLWB: Process_colorNumber(str, lp->io_cancelled_write_bytes, coloring); return;
-   case IO_READ_RATE:  Process_outputRate(str, buffer, n, lp->io_rate_read_bps, coloring); return;
-   case IO_WRITE_RATE: Process_outputRate(str, buffer, n, lp->io_rate_write_bps, coloring); return;
+   case RCHAR:  Process_colorNumber(str, LinuxProcess_io(lp)->rchar, coloring); return;
+   case WCHAR:  Process_colorNumber(str, LinuxProcess_io(lp)->wchar, coloring); return;
+   case SYSCR:  Process_colorNumber(str, LinuxProcess_io(lp)->syscr, coloring); return;
+   case SYSCW:  Process_colorNumber(str, LinuxProcess_io(lp)->syscw, coloring); return;
+   case RBYTES: Process_colorNumber(str, LinuxProcess_io(lp)->read_bytes, coloring); return;
+   case WBYTES: Process_colorNumber(str, LinuxProcess_io(lp)->write_bytes, coloring); return;
+   case CNCLWB: Process_colorNumber(str, LinuxProcess_io(lp)->cancelled_write_bytes, coloring); return;
+   case IO_READ_RATE:  Process_outputRate(str, buffer, n, LinuxProcess_io(lp)->rate_read_bps, coloring); return;
+   case IO_WRITE_RATE: Process_outputRate(str, buffer, n, LinuxProcess_io(lp)->rate_write_bps, coloring); return;
    case IO_RATE: {
-      double totalRate = (lp->io_rate_read_bps != -1)
-                       ? (lp->io_rate_read_bps + lp->io_rate_write_bps)
+      const LinuxProcessIO* io = LinuxProcess_io(lp);
+      double totalRate = (io->rate_read_bps != -1)
+                       ? (io->rate_read_bps + io->rate_write_bps)
                        : -1;
       Process_outputRate(str, buffer, n, totalRate, coloring); return;
    }
    #endif
    #ifdef HAVE_OPENVZ
-   case CTID: xSnprintf(buffer, n, "%7u ", lp->ctid); break;
-   case VPID: xSnprintf(buffer, n, Process_pidFormat, lp->vpid); break;
+   case CTID: String_formatUnsigned(buffer, lp->ctid, 7); strcat(buffer, " "); break;
+   case VPID: Process_formatPid(buffer, lp->vpid); break;
    #endif
    #ifdef HAVE_VSERVER
-   case VXID: xSnprintf(buffer, n, "%5u ", lp->vxid); break;
+   case VXID: String_formatUnsigned(buffer, lp->vxid, 5); strcat(buffer, " "); break;
    #endif
    #ifdef HAVE_CGROUP
    case CGROUP: xSnprintf(buffer, n, "%-10s ", lp->cgroup); break;
    #endif
-   case OOM: xSnprintf(buffer, n, Process_pidFormat, lp->oom); break;
+   case OOM: Process_formatPid(buffer, lp->oom); break;
    case IO_PRIORITY: {
       int klass = IOPriority_class(lp->ioPriority);
       if (klass == IOPRIO_CLASS_NONE) {
@@ -402,92 +682,102 @@ void LinuxProcess_writeField(Process* this, RichString* str, ProcessField field)
       break;
    }
    #ifdef HAVE_DELAYACCT
-   case PERCENT_CPU_DELAY: LinuxProcess_printDelay(lp->cpu_delay_percent, buffer, n); break;
-   case PERCENT_IO_DELAY: LinuxProcess_printDelay(lp->blkio_delay_percent, buffer, n); break;
-   case PERCENT_SWAP_DELAY: LinuxProcess_printDelay(lp->swapin_delay_percent, buffer, n); break;
+   case PERCENT_CPU_DELAY: LinuxProcess_printDelay(LinuxProcess_delay(lp)->cpu_percent, buffer, n); break;
+   case PERCENT_IO_DELAY: LinuxProcess_printDelay(LinuxProcess_delay(lp)->blkio_percent, buffer, n); break;
+   case PERCENT_SWAP_DELAY: LinuxProcess_printDelay(LinuxProcess_delay(lp)->swapin_percent, buffer, n); break;
    #endif
    default:
       Process_writeField((Process*)this, str, field);
       return;
    }
+   if (lp->staleFlags & Process_fields[field].flags)
+      attr = CRT_colors[PROCESS_SHADOW];
    RichString_append(str, attr, buffer);
 }
 
 long LinuxProcess_compare(const void* v1, const void* v2) {
-   LinuxProcess *p1, *p2;
    Settings *settings = ((Process*)v1)->settings;
-   if (settings->direction == 1) {
-      p1 = (LinuxProcess*)v1;
-      p2 = (LinuxProcess*)v2;
-   } else {
-      p2 = (LinuxProcess*)v1;
-      p1 = (LinuxProcess*)v2;
-   }
-   long long diff;
-   switch ((int)settings->sortKey) {
+   Object_Compare compare = Process_getComparator(settings->sortKey, settings->direction);
+   if (!compare)
+      return Process_compare(v1, v2);
+   return compare(v1, v2);
+}
+
+bool LinuxProcess_sortKey(const LinuxProcess* this, ProcessField field, unsigned long long* key) {
+   switch ((int)field) {
    case M_DRS:
-      return (p2->m_drs - p1->m_drs);
+      *key = Process_descendingKey(Process_signedKey(this->m_drs)); break;
    case M_DT:
-      return (p2->m_dt - p1->m_dt);
+      *key = Process_descendingKey(Process_signedKey(this->m_dt)); break;
    case M_LRS:
-      return (p2->m_lrs - p1->m_lrs);
+      *key = Process_descendingKey(Process_signedKey(this->m_lrs)); break;
    case M_TRS:
-      return (p2->m_trs - p1->m_trs);
+      *key = Process_descendingKey(Process_signedKey(this->m_trs)); break;
    case M_SHARE:
-      return (p2->m_share - p1->m_share);
-   case UTIME:  diff = p2->utime - p1->utime; goto test_diff;
-   case CUTIME: diff = p2->cutime - p1->cutime; goto test_diff;
-   case STIME:  diff = p2->stime - p1->stime; goto test_diff;
-   case CSTIME: diff = p2->cstime - p1->cstime; goto test_diff;
-   case STARTTIME: {
-      if (p1->starttime == p2->starttime)
-         return (p1->super.pid - p2->super.pid);
-      else
-         return (p1->starttime - p2->starttime);
-   }
+      *key = Process_descendingKey(Process_signedKey(this->m_share)); break;
+   case UTIME:
+      *key = Process_descendingKey(Process_unsignedKey(this->utime)); break;
+   case CUTIME:
+      *key = Process_descendingKey(Process_unsignedKey(this->cutime)); break;
+   case STIME:
+      *key = Process_descendingKey(Process_unsignedKey(this->stime)); break;
+   case CSTIME:
+      *key = Process_descendingKey(Process_unsignedKey(this->cstime)); break;
+   case STARTTIME:
+      *key = Process_unsignedKey(this->starttime); break;
    #ifdef HAVE_TASKSTATS
-   case RCHAR:  diff = p2->io_rchar - p1->io_rchar; goto test_diff;
-   case WCHAR:  diff = p2->io_wchar - p1->io_wchar; goto test_diff;
-   case SYSCR:  diff = p2->io_syscr - p1->io_syscr; goto test_diff;
-   case SYSCW:  diff = p2->io_syscw - p1->io_syscw; goto test_diff;
-   case RBYTES: diff = p2->io_read_bytes - p1->io_read_bytes; goto test_diff;
-   case WBYTES: diff = p2->io_write_bytes - p1->io_write_bytes; goto test_diff;
-   case CNCLWB: diff = p2->io_cancelled_write_bytes - p1->io_cancelled_write_bytes; goto test_diff;
-   case IO_READ_RATE:  diff = p2->io_rate_read_bps - p1->io_rate_read_bps; goto test_diff;
-   case IO_WRITE_RATE: diff = p2->io_rate_write_bps - p1->io_rate_write_bps; goto test_diff;
-   case IO_RATE: diff = (p2->io_rate_read_bps + p2->io_rate_write_bps) - (p1->io_rate_read_bps + p1->io_rate_write_bps); goto test_diff;
+   case RCHAR:
+      *key = Process_descendingKey(Process_unsignedKey(LinuxProcess_io(this)->rchar)); break;
+   case WCHAR:
+      *key = Process_descendingKey(Process_unsignedKey(LinuxProcess_io(this)->wchar)); break;
+   case SYSCR:
+      *key = Process_descendingKey(Process_unsignedKey(LinuxProcess_io(this)->syscr)); break;
+   case SYSCW:
+      *key = Process_descendingKey(Process_unsignedKey(LinuxProcess_io(this)->syscw)); break;
+   case RBYTES:
+      *key = Process_descendingKey(Process_unsignedKey(LinuxProcess_io(this)->read_bytes)); break;
+   case WBYTES:
+      *key = Process_descendingKey(Process_unsignedKey(LinuxProcess_io(this)->write_bytes)); break;
+   case CNCLWB:
+      *key = Process_descendingKey(Process_unsignedKey(LinuxProcess_io(this)->cancelled_write_bytes)); break;
+   case IO_READ_RATE:
+      *key = Process_descendingKey(Process_floatKey(LinuxProcess_io(this)->rate_read_bps)); break;
+   case IO_WRITE_RATE:
+      *key = Process_descendingKey(Process_floatKey(LinuxProcess_io(this)->rate_write_bps)); break;
+   case IO_RATE:
+      *key = Process_descendingKey(Process_floatKey(LinuxProcess_io(this)->rate_read_bps + LinuxProcess_io(this)->rate_write_bps));
+      break;
    #endif
    #ifdef HAVE_OPENVZ
    case CTID:
-      return (p2->ctid - p1->ctid);
+      *key = Process_descendingKey(Process_unsignedKey(this->ctid)); break;
    case VPID:
-      return (p2->vpid - p1->vpid);
+      *key = Process_descendingKey(Process_unsignedKey(this->vpid)); break;
    #endif
    #ifdef HAVE_VSERVER
    case VXID:
-      return (p2->vxid - p1->vxid);
+      *key = Process_descendingKey(Process_unsignedKey(this->vxid)); break;
    #endif
    #ifdef HAVE_CGROUP
    case CGROUP:
-      return strcmp(p1->cgroup ? p1->cgroup : "", p2->cgroup ? p2->cgroup : "");
+      *key = Process_unsignedKey(LinuxProcess_cgroupRank(this)); break;
    #endif
    case OOM:
-      return (p2->oom - p1->oom);
+      *key = Process_descendingKey(Process_unsignedKey(this->oom)); break;
    #ifdef HAVE_DELAYACCT
    case PERCENT_CPU_DELAY:
-      return (p2->cpu_delay_percent > p1->cpu_delay_percent ? 1 : -1);
+      *key = Process_descendingKey(Process_floatKey(LinuxProcess_delay(this)->cpu_percent)); break;
    case PERCENT_IO_DELAY:
-      return (p2->blkio_delay_percent > p1->blkio_delay_percent ? 1 : -1);
+      *key = Process_descendingKey(Process_floatKey(LinuxProcess_delay(this)->blkio_percent)); break;
    case PERCENT_SWAP_DELAY:
-      return (p2->swapin_delay_percent > p1->swapin_delay_percent ? 1 : -1);
+      *key = Process_descendingKey(Process_floatKey(LinuxProcess_delay(this)->swapin_percent)); break;
    #endif
    case IO_PRIORITY:
-      return LinuxProcess_effectiveIOPriority(p1) - LinuxProcess_effectiveIOPriority(p2);
+      *key = Process_signedKey(LinuxProcess_effectiveIOPriority(this)); break;
    default:
-      return Process_compare(v1, v2);
+      return Process_sortKey((const Process*) this, field, key);
    }
-   test_diff:
-   return (diff > 0) ? 1 : (diff < 0 ? -1 : 0);
+   return true;
 }
 
 bool Process_isThread(Process* this) {
@@ -11,6 +11,8 @@ in the source distribution for its full text.
 #include "StringUtils.h"
 #include <errno.h>
 #include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/select.h>
 #include <sys/utsname.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -26,6 +28,9 @@ in the source distribution for its full text.
 #include <assert.h>
 #include <sys/types.h>
 #include <fcntl.h>
+#ifdef HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif
 #ifdef MAJOR_IN_MKDEV
 #include <sys/mkdev.h>
 #elif defined(MAJOR_IN_SYSMACROS) || \
@@ -84,6 +89,23 @@ typedef struct TtyDriver_ {
    unsigned int minorTo;
 } TtyDriver;
 
+typedef struct LinuxAllocCounters_ {
+   unsigned long long processes;
+   unsigned long long processChunks;
+   unsigned long long processFrees;
+   unsigned long long strings;
+   unsigned long long stringsShared;
+   unsigned long long stringsReclaimed;
+} LinuxAllocCounters;
+
+typedef struct LinuxScanCounters_ {
+   unsigned long long keptFdHits;
+   unsigned long long keptFdMisses;
+   // cmdline files read for updateProcessNames, and reads skipped
+   unsigned long long cmdlineReads;
+   unsigned long long cmdlineSkips;
+} LinuxScanCounters;
+
 typedef struct LinuxProcessList_ {
    ProcessList super;
    
@@ -94,6 +116,27 @@ typedef struct LinuxProcessList_ {
    struct nl_sock *netlink_socket;
    int netlink_family;
    #endif
+
+   int procsRunning;
+
+   int keptFdLimit;
+
+   unsigned int scanCount;
+   #ifdef HAVE_DELAYACCT
+   unsigned int delayAcctRound;
+   #endif
+
+   // bytes written by htop, ever and per second over the last scan
+   unsigned long long outputBytes;
+   double outputRate;
+   double outputTime;
+
+   // process and string allocator counters, ever and since the last scan
+   LinuxAllocCounters allocTotal;
+   LinuxAllocCounters allocTick;
+
+   // file reads of the last scan
+   LinuxScanCounters scanTick;
 } LinuxProcessList;
 
 #ifndef PROCDIR
@@ -116,12 +159,82 @@ typedef struct LinuxProcessList_ {
 #define PROC_LINE_LENGTH 4096
 #endif
 
+// fields of /proc/<pid>/stat, numbered from 1 as in proc(5)
+typedef enum LinuxStatField_ {
+   STAT_PPID = 4,
+   STAT_PGRP = 5,
+   STAT_SESSION = 6,
+   STAT_TTY_NR = 7,
+   STAT_TPGID = 8,
+   STAT_FLAGS = 9,
+   STAT_MINFLT = 10,
+   STAT_CMINFLT = 11,
+   STAT_MAJFLT = 12,
+   STAT_CMAJFLT = 13,
+   STAT_UTIME = 14,
+   STAT_STIME = 15,
+   STAT_CUTIME = 16,
+   STAT_CSTIME = 17,
+   STAT_PRIORITY = 18,
+   STAT_NICE = 19,
+   STAT_NLWP = 20,
+   STAT_STARTTIME = 22,
+   STAT_STARTCODE = 26,
+   STAT_ENDCODE = 27,
+   STAT_EXIT_SIGNAL = 38,
+   STAT_PROCESSOR = 39,
+   // OpenVZ kernels append these
+   STAT_VPID = 52,
+   STAT_CTID = 53,
+} LinuxStatField;
+
+// index in the fields split from the state on
+#define STAT_FIELD(name_) (STAT_ ## name_ - STAT_PPID)
+
+#ifndef PROC_STAT_FIELDS
+#define PROC_STAT_FIELDS (STAT_FIELD(CTID) + 1)
+#endif
+
+#ifndef MAX_KEPT_FDS
+// descriptors opened later, such as the strace pipe, go to select()
+#define MAX_KEPT_FDS (FD_SETSIZE - 128)
+#endif
+
+// with updateProcessNames, scans between re-reads of a cmdline that shows
+// no sign of an exec, to catch processes that rewrite their argv
+#ifndef CMDLINE_REVERIFY_PERIOD
+#define CMDLINE_REVERIFY_PERIOD 8
+#endif
+
+// with hideKernelThreads, scans between reads of a kernel thread's stat,
+// to notice its PID being taken by another process
+#ifndef KERNEL_THREAD_REVERIFY_PERIOD
+#define KERNEL_THREAD_REVERIFY_PERIOD 8
+#endif
+
+// with lowBandwidth, smallest change of CPU% shown, in percentage points
+#ifndef LOW_BANDWIDTH_CPU_STEP
+#define LOW_BANDWIDTH_CPU_STEP 0.5
+#endif
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
+#ifdef O_PATH
+#define PROC_DIR_FLAGS (O_PATH | O_DIRECTORY | O_CLOEXEC)
+#else
+#define PROC_DIR_FLAGS (O_RDONLY | O_DIRECTORY | O_CLOEXEC)
+#endif
+
 }*/
 
 #ifndef CLAMP
 #define CLAMP(x,low,high) (((x)>(high))?(high):(((x)<(low))?(low):(x)))
 #endif
 
+static double jiffy = 0.0;
+
 static ssize_t xread(int fd, void *buf, size_t count) {
   // Read some bytes. Retry on EINTR and when we don't get as many bytes as we requested.
   size_t alreadyRead = 0;
@@ -138,6 +251,46 @@ static ssize_t xread(int fd, void *buf, size_t count) {
   }
 }
 
+typedef struct LinuxProcessScanner_ {
+   LinuxProcessList* pl;
+   double period;
+   unsigned long long now;
+   unsigned int scanCount;
+
+   // scratch buffer for stat files, private to each worker
+   char buf[MAX_READ+1];
+   // numbers in the last stat file read, from ppid on
+   unsigned long long statFields[PROC_STAT_FIELDS];
+   int statFieldCount;
+
+   // processes seen for the first time, added to the list by the main thread
+   Process** added;
+   int addedCount;
+   int addedSize;
+
+   // reads served by descriptors kept from earlier scans, and the rest
+   int keptFdHits;
+   int keptFdMisses;
+
+   int cmdlineReads;
+   int cmdlineSkips;
+
+   int totalTasks;
+   int runningTasks;
+   int userlandThreads;
+   int kernelThreads;
+} LinuxProcessScanner;
+
+static FILE* fopenat(int dirFd, const char* pathname) {
+   int fd = openat(dirFd, pathname, O_RDONLY | O_CLOEXEC);
+   if (fd == -1)
+      return NULL;
+   FILE* file = fdopen(fd, "r");
+   if (!file)
+      close(fd);
+   return file;
+}
+
 static int sortTtyDrivers(const void* va, const void* vb) {
    TtyDriver* a = (TtyDriver*) va;
    TtyDriver* b = (TtyDriver*) vb;
@@ -233,6 +386,13 @@ ProcessList* ProcessList_new(UsersTable* usersTable, Hashtable* pidWhiteList, ui
    LinuxProcessList* this = xCalloc(1, sizeof(LinuxProcessList));
    ProcessList* pl = &(this->super);
 
+   if (!LinuxProcess_slab)
+      LinuxProcess_slab = Slab_new(sizeof(LinuxProcess), 256);
+   if (!LinuxProcess_strings)
+      LinuxProcess_strings = StringPool_new();
+   if (!LinuxProcess_cgroups)
+      LinuxProcess_cgroups = StringPool_new();
+
    ProcessList_init(pl, Class(LinuxProcess), usersTable, pidWhiteList, userId);
    LinuxProcessList_initTtyDrivers(this);
 
@@ -240,6 +400,8 @@ ProcessList* ProcessList_new(UsersTable* usersTable, Hashtable* pidWhiteList, ui
    LinuxProcessList_initNetlinkSocket(this);
    #endif
 
+   pl->tracksChanges = true;
+
    // Update CPU count:
    FILE* file = fopen(PROCSTATFILE, "r");
    if (file == NULL) {
@@ -260,6 +422,16 @@ ProcessList* ProcessList_new(UsersTable* usersTable, Hashtable* pidWhiteList, ui
 
    fclose(file);
 
+   // set once here, as stat files may be parsed by several threads
+   jiffy = sysconf(_SC_CLK_TCK);
+
+   // Descriptors kept open across scans may take up to half of the
+   // descriptor limit, which is left as it is for the programs htop runs.
+   struct rlimit limit;
+   this->keptFdLimit = MAX_KEPT_FDS;
+   if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY)
+      this->keptFdLimit = MIN(limit.rlim_cur / 2, MAX_KEPT_FDS);
+
    pl->cpuCount = MAX(cpus - 1, 1);
    this->cpus = xCalloc(cpus, sizeof(CPUData));
 
@@ -273,6 +445,12 @@ ProcessList* ProcessList_new(UsersTable* usersTable, Hashtable* pidWhiteList, ui
 void ProcessList_delete(ProcessList* pl) {
    LinuxProcessList* this = (LinuxProcessList*) pl;
    ProcessList_done(pl);
+   Slab_delete(LinuxProcess_slab);
+   LinuxProcess_slab = NULL;
+   StringPool_delete(LinuxProcess_strings);
+   LinuxProcess_strings = NULL;
+   StringPool_delete(LinuxProcess_cgroups);
+   LinuxProcess_cgroups = NULL;
    free(this->cpus);
    if (this->ttyDrivers) {
       for(int i = 0; this->ttyDrivers[i].path; i++) {
@@ -289,26 +467,70 @@ void ProcessList_delete(ProcessList* pl) {
    free(this);
 }
 
-static double jiffy = 0.0;
-
 static inline unsigned long long LinuxProcess_adjustTime(unsigned long long t) {
-   if(jiffy == 0.0) jiffy = sysconf(_SC_CLK_TCK);
    double jiffytime = 1.0 / jiffy;
    return (unsigned long long) t * jiffytime * 100;
 }
 
-static bool LinuxProcessList_readStatFile(Process *process, const char* dirname, const char* name, char* command, int* commLen) {
-   LinuxProcess* lp = (LinuxProcess*) process;
-   char filename[MAX_NAME+1];
-   xSnprintf(filename, MAX_NAME, "%s/%s/stat", dirname, name);
-   int fd = open(filename, O_RDONLY);
+static bool LinuxProcessList_reserveKeptFd(LinuxProcessList* this) {
+   if (__sync_add_and_fetch(&LinuxProcess_keptFds, 1) <= this->keptFdLimit)
+      return true;
+   __sync_sub_and_fetch(&LinuxProcess_keptFds, 1);
+   return false;
+}
+
+static ssize_t LinuxProcessList_readKeptFile(LinuxProcessScanner* scanner, int dirFd, const char* name, int* keptFd, char* buf, size_t count) {
+   // Reads through the descriptor kept from an earlier scan, if any,
+   // rewinding with pread(). Otherwise the file is opened and, while
+   // within budget, its descriptor kept for the next scan.
+   if (*keptFd != -1) {
+      ssize_t size = pread(*keptFd, buf, count, 0);
+      if (size > 0) {
+         scanner->keptFdHits++;
+         return size;
+      }
+      LinuxProcess_closeFile(keptFd);
+   }
+   scanner->keptFdMisses++;
+   int fd = openat(dirFd, name, O_RDONLY | O_CLOEXEC);
    if (fd == -1)
-      return false;
+      return -1;
+   ssize_t size = xread(fd, buf, count);
+   if (size > 0 && LinuxProcessList_reserveKeptFd(scanner->pl))
+      *keptFd = fd;
+   else
+      close(fd);
+   return size;
+}
 
-   static char buf[MAX_READ+1];
+static int LinuxProcessList_splitStat(const char* location, unsigned long long* field, int count) {
+   // One pass over the numeric fields that follow the state, which may
+   // be negative; stops at the first field that is not a number.
+   const char* p = location;
+   int n = 0;
+   while (n < count) {
+      bool negative = (*p == '-');
+      p += negative;
+      unsigned int digit = (unsigned int)(*p - '0');
+      if (digit > 9)
+         break;
+      unsigned long long value = 0;
+      do {
+         value = value * 10 + digit;
+         digit = (unsigned int)(*++p - '0');
+      } while (digit <= 9);
+      field[n++] = negative ? 0 - value : value;
+      if (*p != ' ')
+         break;
+      p++;
+   }
+   return n;
+}
 
-   int size = xread(fd, buf, MAX_READ);
-   close(fd);
+static bool LinuxProcessList_readStatFile(LinuxProcessScanner* scanner, Process *process, int dirFd, char* command, int* commLen) {
+   LinuxProcess* lp = (LinuxProcess*) process;
+   char* buf = scanner->buf;
+   int size = LinuxProcessList_readKeptFile(scanner, dirFd, "stat", &(lp->statFd), buf, MAX_READ);
    if (size <= 0) return false;
    buf[size] = '\0';
 
@@ -328,48 +550,37 @@ static bool LinuxProcessList_readStatFile(Process *process, const char* dirname,
 
    process->state = location[0];
    location += 2;
-   process->ppid = strtol(location, &location, 10);
-   location += 1;
-   process->pgrp = strtoul(location, &location, 10);
-   location += 1;
-   process->session = strtoul(location, &location, 10);
-   location += 1;
-   process->tty_nr = strtoul(location, &location, 10);
-   location += 1;
-   process->tpgid = strtol(location, &location, 10);
-   location += 1;
-   process->flags = strtoul(location, &location, 10);
-   location += 1;
-   process->minflt = strtoull(location, &location, 10);
-   location += 1;
-   lp->cminflt = strtoull(location, &location, 10);
-   location += 1;
-   process->majflt = strtoull(location, &location, 10);
-   location += 1;
-   lp->cmajflt = strtoull(location, &location, 10);
-   location += 1;
-   lp->utime = LinuxProcess_adjustTime(strtoull(location, &location, 10));
-   location += 1;
-   lp->stime = LinuxProcess_adjustTime(strtoull(location, &location, 10));
-   location += 1;
-   lp->cutime = LinuxProcess_adjustTime(strtoull(location, &location, 10));
-   location += 1;
-   lp->cstime = LinuxProcess_adjustTime(strtoull(location, &location, 10));
-   location += 1;
-   process->priority = strtol(location, &location, 10);
-   location += 1;
-   process->nice = strtol(location, &location, 10);
-   location += 1;
-   process->nlwp = strtol(location, &location, 10);
-   location += 1;
-   location = strchr(location, ' ')+1;
-   lp->starttime = strtoll(location, &location, 10);
-   location += 1;
-   for (int i=0; i<15; i++) location = strchr(location, ' ')+1;
-   process->exit_signal = strtol(location, &location, 10);
-   location += 1;
-   assert(location != NULL);
-   process->processor = strtol(location, &location, 10);
+   unsigned long long* field = scanner->statFields;
+   int count = STAT_FIELD(PROCESSOR) + 1;
+   #ifdef HAVE_OPENVZ
+   // the OpenVZ ids are taken from the same file
+   if (scanner->pl->super.settings->flags & PROCESS_FLAG_LINUX_OPENVZ)
+      count = PROC_STAT_FIELDS;
+   #endif
+   scanner->statFieldCount = LinuxProcessList_splitStat(location, field, count);
+   if (scanner->statFieldCount < STAT_FIELD(PROCESSOR) + 1)
+      return false;
+
+   process->ppid = field[STAT_FIELD(PPID)];
+   process->pgrp = field[STAT_FIELD(PGRP)];
+   process->session = field[STAT_FIELD(SESSION)];
+   process->tty_nr = field[STAT_FIELD(TTY_NR)];
+   process->tpgid = field[STAT_FIELD(TPGID)];
+   process->flags = field[STAT_FIELD(FLAGS)];
+   process->minflt = field[STAT_FIELD(MINFLT)];
+   lp->cminflt = field[STAT_FIELD(CMINFLT)];
+   process->majflt = field[STAT_FIELD(MAJFLT)];
+   lp->cmajflt = field[STAT_FIELD(CMAJFLT)];
+   lp->utime = LinuxProcess_adjustTime(field[STAT_FIELD(UTIME)]);
+   lp->stime = LinuxProcess_adjustTime(field[STAT_FIELD(STIME)]);
+   lp->cutime = LinuxProcess_adjustTime(field[STAT_FIELD(CUTIME)]);
+   lp->cstime = LinuxProcess_adjustTime(field[STAT_FIELD(CSTIME)]);
+   process->priority = field[STAT_FIELD(PRIORITY)];
+   process->nice = field[STAT_FIELD(NICE)];
+   process->nlwp = field[STAT_FIELD(NLWP)];
+   lp->starttime = field[STAT_FIELD(STARTTIME)];
+   process->exit_signal = field[STAT_FIELD(EXIT_SIGNAL)];
+   process->processor = field[STAT_FIELD(PROCESSOR)];
    
    process->time = lp->utime + lp->stime;
    
@@ -377,13 +588,9 @@ static bool LinuxProcessList_readStatFile(Process *process, const char* dirname,
 }
 
 
-static bool LinuxProcessList_statProcessDir(Process* process, const char* dirname, char* name) {
-   char filename[MAX_NAME+1];
-   filename[MAX_NAME] = '\0';
-
-   xSnprintf(filename, MAX_NAME, "%s/%s", dirname, name);
+static bool LinuxProcessList_statProcessDir(Process* process, int dirFd) {
    struct stat sstat;
-   int statok = stat(filename, &sstat);
+   int statok = fstat(dirFd, &sstat);
    if (statok == -1)
       return false;
    process->st_uid = sstat.st_uid;
@@ -392,24 +599,23 @@ static bool LinuxProcessList_statProcessDir(Process* process, const char* dirnam
 
 #ifdef HAVE_TASKSTATS
 
-static void LinuxProcessList_readIoFile(LinuxProcess* process, const char* dirname, char* name, unsigned long long now) {
-   char filename[MAX_NAME+1];
-   filename[MAX_NAME] = '\0';
-
-   xSnprintf(filename, MAX_NAME, "%s/%s/io", dirname, name);
-   int fd = open(filename, O_RDONLY);
+static void LinuxProcessList_readIoFile(LinuxProcess* process, int dirFd, unsigned long long now) {
+   if (!process->io)
+      process->io = xCalloc(1, sizeof(LinuxProcessIO));
+   LinuxProcessIO* io = process->io;
+   int fd = openat(dirFd, "io", O_RDONLY | O_CLOEXEC);
    if (fd == -1) {
-      process->io_rate_read_bps = -1;
-      process->io_rate_write_bps = -1;
-      process->io_rchar = -1LL;
-      process->io_wchar = -1LL;
-      process->io_syscr = -1LL;
-      process->io_syscw = -1LL;
-      process->io_read_bytes = -1LL;
-      process->io_write_bytes = -1LL;
-      process->io_cancelled_write_bytes = -1LL;
-      process->io_rate_read_time = -1LL;
-      process->io_rate_write_time = -1LL;
+      io->rate_read_bps = -1;
+      io->rate_write_bps = -1;
+      io->rchar = -1LL;
+      io->wchar = -1LL;
+      io->syscr = -1LL;
+      io->syscw = -1LL;
+      io->read_bytes = -1LL;
+      io->write_bytes = -1LL;
+      io->cancelled_write_bytes = -1LL;
+      io->rate_read_time = -1LL;
+      io->rate_write_time = -1LL;
       return;
    }
    
@@ -418,42 +624,42 @@ static void LinuxProcessList_readIoFile(LinuxProcess* process, const char* dirna
    close(fd);
    if (buflen < 1) return;
    buffer[buflen] = '\0';
-   unsigned long long last_read = process->io_read_bytes;
-   unsigned long long last_write = process->io_write_bytes;
+   unsigned long long last_read = io->read_bytes;
+   unsigned long long last_write = io->write_bytes;
    char *buf = buffer;
    char *line = NULL;
    while ((line = strsep(&buf, "\n")) != NULL) {
       switch (line[0]) {
       case 'r':
          if (line[1] == 'c' && strncmp(line+2, "har: ", 5) == 0)
-            process->io_rchar = strtoull(line+7, NULL, 10);
+            io->rchar = strtoull(line+7, NULL, 10);
          else if (strncmp(line+1, "ead_bytes: ", 11) == 0) {
-            process->io_read_bytes = strtoull(line+12, NULL, 10);
-            process->io_rate_read_bps = 
-               ((double)(process->io_read_bytes - last_read))/(((double)(now - process->io_rate_read_time))/1000);
-            process->io_rate_read_time = now;
+            io->read_bytes = strtoull(line+12, NULL, 10);
+            io->rate_read_bps = 
+               ((double)(io->read_bytes - last_read))/(((double)(now - io->rate_read_time))/1000);
+            io->rate_read_time = now;
          }
          break;
       case 'w':
          if (line[1] == 'c' && strncmp(line+2, "har: ", 5) == 0)
-            process->io_wchar = strtoull(line+7, NULL, 10);
+            io->wchar = strtoull(line+7, NULL, 10);
          else if (strncmp(line+1, "rite_bytes: ", 12) == 0) {
-            process->io_write_bytes = strtoull(line+13, NULL, 10);
-            process->io_rate_write_bps = 
-               ((double)(process->io_write_bytes - last_write))/(((double)(now - process->io_rate_write_time))/1000);
-            process->io_rate_write_time = now;
+            io->write_bytes = strtoull(line+13, NULL, 10);
+            io->rate_write_bps = 
+               ((double)(io->write_bytes - last_write))/(((double)(now - io->rate_write_time))/1000);
+            io->rate_write_time = now;
          }
          break;
       case 's':
          if (line[4] == 'r' && strncmp(line+1, "yscr: ", 6) == 0) {
-            process->io_syscr = strtoull(line+7, NULL, 10);
+            io->syscr = strtoull(line+7, NULL, 10);
          } else if (strncmp(line+1, "yscw: ", 6) == 0) {
-            process->io_syscw = strtoull(line+7, NULL, 10);
+            io->syscw = strtoull(line+7, NULL, 10);
          }
          break;
       case 'c':
          if (strncmp(line+1, "ancelled_write_bytes: ", 22) == 0) {
-           process->io_cancelled_write_bytes = strtoull(line+23, NULL, 10);
+           io->cancelled_write_bytes = strtoull(line+23, NULL, 10);
         }
       }
    }
@@ -463,16 +669,29 @@ static void LinuxProcessList_readIoFile(LinuxProcess* process, const char* dirna
 
 
 
-static bool LinuxProcessList_readStatmFile(LinuxProcess* process, const char* dirname, const char* name) {
-   char filename[MAX_NAME+1];
-   xSnprintf(filename, MAX_NAME, "%s/%s/statm", dirname, name);
-   int fd = open(filename, O_RDONLY);
-   if (fd == -1)
-      return false;
+static unsigned int LinuxProcessList_statDigest(LinuxProcessScanner* scanner, LinuxProcess* lp) {
+   // digest of the values read from stat and statm, and of those computed from them
+   const Process* p = &(lp->super);
+   float percent[] = { p->percent_cpu, p->percent_mem };
+   unsigned int percentBits[2];
+   memcpy(percentBits, percent, sizeof(percentBits));
+   unsigned long long values[] = {
+      p->state, percentBits[0], percentBits[1],
+      p->m_size, p->m_resident, lp->m_share, lp->m_trs, lp->m_lrs, lp->m_drs, lp->m_dt,
+   };
+   unsigned long long digest = 14695981039346656037ULL;
+   for (unsigned int i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+      digest = (digest ^ values[i]) * 1099511628211ULL;
+   for (int i = 0; i < scanner->statFieldCount; i++)
+      digest = (digest ^ scanner->statFields[i]) * 1099511628211ULL;
+   return digest ^ (digest >> 32);
+}
+
+static bool LinuxProcessList_readStatmFile(LinuxProcessScanner* scanner, LinuxProcess* process, int dirFd) {
    char buf[PROC_LINE_LENGTH + 1];
-   ssize_t rres = xread(fd, buf, PROC_LINE_LENGTH);
-   close(fd);
+   ssize_t rres = LinuxProcessList_readKeptFile(scanner, dirFd, "statm", &(process->statmFd), buf, PROC_LINE_LENGTH);
    if (rres < 1) return false;
+   buf[rres] = '\0';
 
    char *p = buf;
    errno = 0;
@@ -488,73 +707,62 @@ static bool LinuxProcessList_readStatmFile(LinuxProcess* process, const char* di
 
 #ifdef HAVE_OPENVZ
 
-static void LinuxProcessList_readOpenVZData(LinuxProcess* process, const char* dirname, const char* name) {
+static void LinuxProcessList_readOpenVZData(LinuxProcessScanner* scanner, LinuxProcess* process) {
    if ( (access("/proc/vz", R_OK) != 0)) {
       process->vpid = process->super.pid;
       process->ctid = 0;
       return;
    }
-   char filename[MAX_NAME+1];
-   xSnprintf(filename, MAX_NAME, "%s/%s/stat", dirname, name);
-   FILE* file = fopen(filename, "r");
-   if (!file)
-      return;
-   (void) fscanf(file,
-      "%*32u %*32s %*1c %*32u %*32u %*32u %*32u %*32u %*32u %*32u "
-      "%*32u %*32u %*32u %*32u %*32u %*32u %*32u %*32u "
-      "%*32u %*32u %*32u %*32u %*32u %*32u %*32u %*32u "
-      "%*32u %*32u %*32u %*32u %*32u %*32u %*32u %*32u "
-      "%*32u %*32u %*32u %*32u %*32u %*32u %*32u %*32u "
-      "%*32u %*32u %*32u %*32u %*32u %*32u %*32u "
-      "%*32u %*32u %32u %32u",
-      &process->vpid, &process->ctid);
-   fclose(file);
-   return;
+   // taken from the stat file already read for this process
+   if (scanner->statFieldCount > STAT_FIELD(CTID)) {
+      process->vpid = scanner->statFields[STAT_FIELD(VPID)];
+      process->ctid = scanner->statFields[STAT_FIELD(CTID)];
+   }
 }
 
 #endif
 
 #ifdef HAVE_CGROUP
 
-static void LinuxProcessList_readCGroupFile(LinuxProcess* process, const char* dirname, const char* name) {
-   char filename[MAX_NAME+1];
-   xSnprintf(filename, MAX_NAME, "%s/%s/cgroup", dirname, name);
-   FILE* file = fopen(filename, "r");
-   if (!file) {
-      process->cgroup = xStrdup("");
-      return;
-   }
+static void LinuxProcessList_readCGroupFile(LinuxProcess* process, int dirFd) {
    char output[PROC_LINE_LENGTH + 1];
-   output[0] = '\0';
-   char* at = output;
-   int left = PROC_LINE_LENGTH;
-   while (!feof(file) && left > 0) {
+   int len = 0;
+   int fd = openat(dirFd, "cgroup", O_RDONLY | O_CLOEXEC);
+   if (fd != -1) {
       char buffer[PROC_LINE_LENGTH + 1];
-      char *ok = fgets(buffer, PROC_LINE_LENGTH, file);
-      if (!ok) break;
-      char* group = strchr(buffer, ':');
-      if (!group) break;
-      if (at != output) {
-         *at = ';';
-         at++;
-         left--;
+      ssize_t size = xread(fd, buffer, PROC_LINE_LENGTH);
+      close(fd);
+      if (size < 0) size = 0;
+      buffer[size] = '\0';
+      // the groups of each line go to the start of output, so the last
+      // line read is the one shown
+      int left = PROC_LINE_LENGTH;
+      for (char* line = buffer; *line && left > 0; ) {
+         char* eol = strchr(line, '\n');
+         char* next = eol ? eol + 1 : line + strlen(line);
+         char* group = memchr(line, ':', next - line);
+         if (!group) break;
+         int groupLen = next - group;
+         len = groupLen < left ? groupLen : left - 1;
+         memcpy(output, group, len);
+         left -= groupLen;
+         line = next;
       }
-      int wrote = snprintf(at, left, "%s", group);
-      left -= wrote;
    }
-   fclose(file);
-   free(process->cgroup);
-   process->cgroup = xStrdup(output);
+   output[len] = '\0';
+   if (process->cgroup && StringPool_length(process->cgroup) == len && memcmp(process->cgroup, output, len) == 0)
+      return;
+   StringPool_release(LinuxProcess_cgroups, process->cgroup);
+   process->cgroup = StringPool_intern(LinuxProcess_cgroups, output, len);
+   process->super.changed |= PROCESS_FLAG_LINUX_CGROUP;
 }
 
 #endif
 
 #ifdef HAVE_VSERVER
 
-static void LinuxProcessList_readVServerData(LinuxProcess* process, const char* dirname, const char* name) {
-   char filename[MAX_NAME+1];
-   xSnprintf(filename, MAX_NAME, "%s/%s/status", dirname, name);
-   FILE* file = fopen(filename, "r");
+static void LinuxProcessList_readVServerData(LinuxProcess* process, int dirFd) {
+   FILE* file = fopenat(dirFd, "status");
    if (!file)
       return;
    char buffer[PROC_LINE_LENGTH + 1];
@@ -582,10 +790,8 @@ static void LinuxProcessList_readVServerData(LinuxProcess* process, const char*
 
 #endif
 
-static void LinuxProcessList_readOomData(LinuxProcess* process, const char* dirname, const char* name) {
-   char filename[MAX_NAME+1];
-   xSnprintf(filename, MAX_NAME, "%s/%s/oom_score", dirname, name);
-   FILE* file = fopen(filename, "r");
+static void LinuxProcessList_readOomData(LinuxProcess* process, int dirFd) {
+   FILE* file = fopenat(dirFd, "oom_score");
    if (!file) {
       return;
    }
@@ -593,8 +799,9 @@ static void LinuxProcessList_readOomData(LinuxProcess* process, const char* dirn
    if (fgets(buffer, PROC_LINE_LENGTH, file)) {
       unsigned int oom;
       int ok = sscanf(buffer, "%32u", &oom);
-      if (ok >= 1) {
+      if (ok >= 1 && process->oom != oom) {
          process->oom = oom;
+         process->super.changed |= PROCESS_FLAG_LINUX_OOM;
       }
    }
    fclose(file);
@@ -620,18 +827,18 @@ static int handleNetlinkMsg(struct nl_msg *nlmsg, void *linuxProcess) {
    if ((nlattr = nlattrs[TASKSTATS_TYPE_AGGR_PID]) || (nlattr = nlattrs[TASKSTATS_TYPE_NULL])) {
       stats = nla_data(nla_next(nla_data(nlattr), &rem));
       assert(lp->super.pid == stats->ac_pid);
-      timeDelta = (stats->ac_etime*1000 - lp->delay_read_time);
+      timeDelta = (stats->ac_etime*1000 - lp->delay->read_time);
       #define BOUNDS(x) isnan(x) ? 0.0 : (x > 100) ? 100.0 : x;
       #define DELTAPERC(x,y) BOUNDS((float) (x - y) / timeDelta * 100);
-      lp->cpu_delay_percent = DELTAPERC(stats->cpu_delay_total, lp->cpu_delay_total);
-      lp->blkio_delay_percent = DELTAPERC(stats->blkio_delay_total, lp->blkio_delay_total);
-      lp->swapin_delay_percent = DELTAPERC(stats->swapin_delay_total, lp->swapin_delay_total);
+      lp->delay->cpu_percent = DELTAPERC(stats->cpu_delay_total, lp->delay->cpu_total);
+      lp->delay->blkio_percent = DELTAPERC(stats->blkio_delay_total, lp->delay->blkio_total);
+      lp->delay->swapin_percent = DELTAPERC(stats->swapin_delay_total, lp->delay->swapin_total);
       #undef DELTAPERC
       #undef BOUNDS
-      lp->swapin_delay_total = stats->swapin_delay_total;
-      lp->blkio_delay_total = stats->blkio_delay_total;
-      lp->cpu_delay_total = stats->cpu_delay_total;
-      lp->delay_read_time = stats->ac_etime*1000;
+      lp->delay->swapin_total = stats->swapin_delay_total;
+      lp->delay->blkio_total = stats->blkio_delay_total;
+      lp->delay->cpu_total = stats->cpu_delay_total;
+      lp->delay->read_time = stats->ac_etime*1000;
    }
    return NL_OK;
 }
@@ -639,6 +846,10 @@ static int handleNetlinkMsg(struct nl_msg *nlmsg, void *linuxProcess) {
 static void LinuxProcessList_readDelayAcctData(LinuxProcessList* this, LinuxProcess* process) {
    struct nl_msg *msg;
 
+   if (!process->delay)
+      process->delay = xCalloc(1, sizeof(LinuxProcessDelay));
+   process->super.changed |= PROCESS_FLAG_LINUX_DELAYACCT;
+
    if (nl_socket_modify_cb(this->netlink_socket, NL_CB_VALID, NL_CB_CUSTOM, handleNetlinkMsg, process) < 0) {
       return;
    }
@@ -656,9 +867,9 @@ static void LinuxProcessList_readDelayAcctData(LinuxProcessList* this, LinuxProc
    }
 
    if (nl_send_sync(this->netlink_socket, msg) < 0) {
-      process->swapin_delay_percent = -1LL;
-      process->blkio_delay_percent = -1LL;
-      process->cpu_delay_percent = -1LL;
+      process->delay->swapin_percent = -1LL;
+      process->delay->blkio_percent = -1LL;
+      process->delay->cpu_percent = -1LL;
       return;
    }
    
@@ -670,19 +881,17 @@ static void LinuxProcessList_readDelayAcctData(LinuxProcessList* this, LinuxProc
 #endif
 
 static void setCommand(Process* process, const char* command, int len) {
-   if (process->comm && process->commLen >= len) {
-      strncpy(process->comm, command, len + 1);
-   } else {
-      free(process->comm);
-      process->comm = xStrdup(command);
-   }
+   if (process->comm && process->commLen == len && memcmp(process->comm, command, len) == 0)
+      return;
+   const char* comm = StringPool_intern(LinuxProcess_strings, command, len);
+   StringPool_release(LinuxProcess_strings, process->comm);
+   process->comm = (char*) comm;
    process->commLen = len;
+   process->changed |= PROCESS_CHANGED_BASE;
 }
 
-static bool LinuxProcessList_readCmdlineFile(Process* process, const char* dirname, const char* name) {
-   char filename[MAX_NAME+1];
-   xSnprintf(filename, MAX_NAME, "%s/%s/cmdline", dirname, name);
-   int fd = open(filename, O_RDONLY);
+static bool LinuxProcessList_readCmdlineFile(Process* process, int dirFd) {
+   int fd = openat(dirFd, "cmdline", O_RDONLY | O_CLOEXEC);
    if (fd == -1)
       return false;
          
@@ -711,13 +920,33 @@ static bool LinuxProcessList_readCmdlineFile(Process* process, const char* dirna
       tokenEnd = amtRead;
    }
    command[lastChar + 1] = '\0';
-   process->basenameOffset = tokenEnd;
+   if (process->basenameOffset != tokenEnd) {
+      process->basenameOffset = tokenEnd;
+      process->changed |= PROCESS_CHANGED_BASE;
+   }
    setCommand(process, command, lastChar + 1);
 
    return true;
 }
 
-static char* LinuxProcessList_updateTtyDevice(TtyDriver* ttyDrivers, unsigned int tty_nr) {
+static void LinuxProcessList_markCmdline(LinuxProcessScanner* scanner, LinuxProcess* lp, const char* command, int commLen) {
+   lp->cmdlineCommHash = StringPool_hash(command, commLen);
+   lp->cmdlineStartCode = scanner->statFields[STAT_FIELD(STARTCODE)];
+   lp->cmdlineEndCode = scanner->statFields[STAT_FIELD(ENDCODE)];
+}
+
+/*
+ * An exec changes the comm and code segment shown in stat; a process
+ * rewriting its argv changes neither, and is caught by the periodic re-read.
+ */
+static bool LinuxProcessList_cmdlineChanged(LinuxProcessScanner* scanner, LinuxProcess* lp, const char* command, int commLen) {
+   return (lp->super.pid + scanner->scanCount) % CMDLINE_REVERIFY_PERIOD == 0
+       || lp->cmdlineStartCode != scanner->statFields[STAT_FIELD(STARTCODE)]
+       || lp->cmdlineEndCode != scanner->statFields[STAT_FIELD(ENDCODE)]
+       || lp->cmdlineCommHash != StringPool_hash(command, commLen);
+}
+
+static const char* LinuxProcessList_findTtyDevice(TtyDriver* ttyDrivers, unsigned int tty_nr, char* device, int size) {
    unsigned int maj = major(tty_nr);
    unsigned int min = minor(tty_nr);
 
@@ -738,183 +967,473 @@ static char* LinuxProcessList_updateTtyDevice(TtyDriver* ttyDrivers, unsigned in
       }
       unsigned int idx = min - ttyDrivers[i].minorFrom;
       struct stat sstat;
-      char* fullPath;
       for(;;) {
-         asprintf(&fullPath, "%s/%d", ttyDrivers[i].path, idx);
-         int err = stat(fullPath, &sstat);
-         if (err == 0 && major(sstat.st_rdev) == maj && minor(sstat.st_rdev) == min) return fullPath;
-         free(fullPath);
-         asprintf(&fullPath, "%s%d", ttyDrivers[i].path, idx);
-         err = stat(fullPath, &sstat);
-         if (err == 0 && major(sstat.st_rdev) == maj && minor(sstat.st_rdev) == min) return fullPath;
-         free(fullPath);
+         snprintf(device, size, "%s/%d", ttyDrivers[i].path, idx);
+         int err = stat(device, &sstat);
+         if (err == 0 && major(sstat.st_rdev) == maj && minor(sstat.st_rdev) == min) return device;
+         snprintf(device, size, "%s%d", ttyDrivers[i].path, idx);
+         err = stat(device, &sstat);
+         if (err == 0 && major(sstat.st_rdev) == maj && minor(sstat.st_rdev) == min) return device;
          if (idx == min) break;
          idx = min;
       }
       int err = stat(ttyDrivers[i].path, &sstat);
-      if (err == 0 && tty_nr == sstat.st_rdev) return strdup(ttyDrivers[i].path);
+      if (err == 0 && tty_nr == sstat.st_rdev) return ttyDrivers[i].path;
    }
-   char* out;
-   asprintf(&out, "/dev/%u:%u", maj, min);
-   return out;
+   snprintf(device, size, "/dev/%u:%u", maj, min);
+   return device;
 }
 
-static bool LinuxProcessList_recurseProcTree(LinuxProcessList* this, const char* dirname, Process* parent, double period, struct timeval tv) {
+
+static bool LinuxProcessList_recurseProcTree(LinuxProcessScanner* scanner, int dirFd, Process* parent);
+
+static void LinuxProcessScanner_add(LinuxProcessScanner* scanner, Process* proc) {
+   if (scanner->addedCount == scanner->addedSize) {
+      scanner->addedSize = scanner->addedSize ? scanner->addedSize * 2 : 64;
+      scanner->added = xRealloc(scanner->added, sizeof(Process*) * scanner->addedSize);
+   }
+   scanner->added[scanner->addedCount++] = proc;
+}
+
+static int LinuxProcessList_openProcDir(LinuxProcessList* this, LinuxProcess* lp, int parentFd, const char* name) {
+   if (lp->procDirFd != -1)
+      return lp->procDirFd;
+   int fd = openat(parentFd, name, PROC_DIR_FLAGS);
+   if (fd == -1)
+      return -1;
+   // keep the handle for later scans while within budget
+   if (LinuxProcessList_reserveKeptFd(this))
+      lp->procDirFd = fd;
+   return fd;
+}
+
+static void LinuxProcessList_readProcess(LinuxProcessScanner* scanner, int parentFd, const char* name, Process* parent) {
+   LinuxProcessList* this = scanner->pl;
    ProcessList* pl = (ProcessList*) this;
-   DIR* dir;
-   struct dirent* entry;
    Settings* settings = pl->settings;
+   int cpus = pl->cpuCount;
+   int pid = atoi(name);
+
+   bool preExisting = false;
+   Process* proc = ProcessList_getProcess(pl, pid, &preExisting, (Process_New) LinuxProcess_new);
+   proc->tgid = parent ? parent->pid : pid;
+
+   LinuxProcess* lp = (LinuxProcess*) proc;
+
+   // Kernel threads never exec, change owner or map memory of their own:
+   // once known, only their stat is read, and hidden ones are only counted.
+   bool kernelThread = preExisting && Process_isKernelThread(proc);
+   if (kernelThread && settings->hideKernelThreads && (pid + scanner->scanCount) % KERNEL_THREAD_REVERIFY_PERIOD != 0) {
+      proc->show = false;
+      lp->statSkipped = true;
+      scanner->kernelThreads++;
+      scanner->totalTasks++;
+      proc->updated = true;
+      return;
+   }
+
+   bool wasOpen = (lp->procDirFd != -1);
+   int dirFd = LinuxProcessList_openProcDir(this, lp, parentFd, name);
+   if (dirFd == -1)
+      goto errorReadingProcess;
+
+   if (!kernelThread && ! LinuxProcessList_readStatmFile(scanner, lp, dirFd)) {
+      if (!wasOpen)
+         goto errorReadingProcess;
+      // The handles kept from an earlier scan belong to a process that
+      // is gone, and its PID was reused since: look the PID up again.
+      LinuxProcess_closeFiles(lp);
+      dirFd = LinuxProcessList_openProcDir(this, lp, parentFd, name);
+      if (dirFd == -1 || ! LinuxProcessList_readStatmFile(scanner, lp, dirFd))
+         goto errorReadingProcess;
+   }
+
+   char command[MAX_NAME+1];
+   unsigned long long int lasttimes = (lp->utime + lp->stime);
+   unsigned long long starttime = lp->starttime;
+   int commLen = 0;
+   unsigned int tty_nr = proc->tty_nr;
+   if (! LinuxProcessList_readStatFile(scanner, proc, dirFd, command, &commLen)) {
+      if (!kernelThread || !wasOpen)
+         goto errorReadingProcess;
+      // as with statm above, for the kernel threads it is not read for
+      LinuxProcess_closeFiles(lp);
+      dirFd = LinuxProcessList_openProcDir(this, lp, parentFd, name);
+      if (dirFd == -1 || ! LinuxProcessList_readStatFile(scanner, proc, dirFd, command, &commLen))
+         goto errorReadingProcess;
+   }
+   // a different start time means the PID now belongs to another process
+   bool reused = preExisting && lp->starttime != starttime;
+   if (reused) {
+      lasttimes = 0;
+      lp->isKernelThread = false;
+      lp->collectedFlags = 0;
+      proc->changed = ~0;
+      if (kernelThread && ! LinuxProcessList_readStatmFile(scanner, lp, dirFd))
+         goto errorReadingProcess;
+      kernelThread = false;
+   } else if (lp->statSkipped) {
+      // the times span several scans: start over from here
+      lasttimes = lp->utime + lp->stime;
+   }
+   lp->statSkipped = false;
+
+   proc->show = ! ((settings->hideKernelThreads && Process_isKernelThread(proc)) || (settings->hideUserlandThreads && Process_isUserlandThread(proc)));
+
+   // Slow fields are read on a share of the processes on each scan,
+   // spread by PID. Expensive fields are only read for processes in
+   // view, or for all when sorting by them. Either way, fields are read
+   // right away for processes that lack them.
+   int lazyFlags = settings->flags & PROCESS_FLAG_LINUX_LAZY;
+   int readFlags = lazyFlags & ~PROCESS_FLAG_LINUX_DELAYACCT;
+   if ((pid + scanner->scanCount) % settings->slowRefreshPeriod != 0)
+      readFlags &= ~PROCESS_FLAG_LINUX_SLOW;
+   if (!proc->inView)
+      readFlags &= Process_fields[settings->sortKey].flags;
+   readFlags |= lazyFlags & ~lp->collectedFlags & ~PROCESS_FLAG_LINUX_DELAYACCT;
+   if (kernelThread)
+      readFlags &= ~lp->collectedFlags;
+   lp->collectedFlags |= readFlags;
+   int staleFlags = kernelThread ? 0 : lazyFlags & ~readFlags;
+   // stale values are shown dimmed
+   proc->changed |= staleFlags ^ lp->staleFlags;
+   lp->staleFlags = staleFlags;
+   if (tty_nr != proc->tty_nr && this->ttyDrivers) {
+      char buffer[PROC_LINE_LENGTH + 1];
+      const char* device = LinuxProcessList_findTtyDevice(this->ttyDrivers, proc->tty_nr, buffer, sizeof(buffer));
+      StringPool_release(LinuxProcess_strings, lp->ttyDevice);
+      lp->ttyDevice = StringPool_intern(LinuxProcess_strings, device, strlen(device));
+   }
+   if (readFlags & PROCESS_FLAG_LINUX_IOPRIO) {
+      IOPriority ioPriority = lp->ioPriority;
+      LinuxProcess_updateIOPriority(lp);
+      if (lp->ioPriority != ioPriority)
+         proc->changed |= PROCESS_FLAG_LINUX_IOPRIO;
+   }
+   float percent_cpu = (lp->utime + lp->stime - lasttimes) / scanner->period * 100.0;
+   percent_cpu = CLAMP(percent_cpu, 0.0, cpus * 100.0);
+   if (isnan(percent_cpu)) percent_cpu = 0.0;
+   // small changes are not shown, so they neither redraw nor reorder rows
+   if (!settings->lowBandwidth || percent_cpu < 0.05 || fabs(percent_cpu - proc->percent_cpu) >= LOW_BANDWIDTH_CPU_STEP)
+      proc->percent_cpu = percent_cpu;
+   proc->percent_mem = (proc->m_resident * PAGE_SIZE_KB) / (double)(pl->totalMem) * 100.0;
+   unsigned int statDigest = LinuxProcessList_statDigest(scanner, lp);
+   if (statDigest != lp->statDigest) {
+      lp->statDigest = statDigest;
+      proc->changed |= PROCESS_CHANGED_BASE;
+   }
+
+   if(!preExisting || reused) {
+
+      if (! LinuxProcessList_statProcessDir(proc, dirFd))
+         goto errorReadingProcess;
+
+      #ifdef HAVE_OPENVZ
+      if (settings->flags & PROCESS_FLAG_LINUX_OPENVZ) {
+         LinuxProcessList_readOpenVZData(scanner, lp);
+      }
+      #endif
+
+      #ifdef HAVE_VSERVER
+      if (settings->flags & PROCESS_FLAG_LINUX_VSERVER) {
+         LinuxProcessList_readVServerData(lp, dirFd);
+      }
+      #endif
+
+      if (! LinuxProcessList_readCmdlineFile(proc, dirFd)) {
+         goto errorReadingProcess;
+      }
+      LinuxProcessList_markCmdline(scanner, lp, command, commLen);
+   } else {
+      if (settings->updateProcessNames && proc->state != 'Z' && !kernelThread) {
+         if (LinuxProcessList_cmdlineChanged(scanner, lp, command, commLen)) {
+            if (! LinuxProcessList_readCmdlineFile(proc, dirFd)) {
+               goto errorReadingProcess;
+            }
+            LinuxProcessList_markCmdline(scanner, lp, command, commLen);
+            scanner->cmdlineReads++;
+         } else {
+            scanner->cmdlineSkips++;
+         }
+      }
+   }
+
+   #ifdef HAVE_CGROUP
+   if (readFlags & PROCESS_FLAG_LINUX_CGROUP)
+      LinuxProcessList_readCGroupFile(lp, dirFd);
+   #endif
+
+   if (readFlags & PROCESS_FLAG_LINUX_OOM)
+      LinuxProcessList_readOomData(lp, dirFd);
 
    #ifdef HAVE_TASKSTATS
-   unsigned long long now = tv.tv_sec*1000LL+tv.tv_usec/1000LL;
+   if (readFlags & PROCESS_FLAG_IO) {
+      LinuxProcessList_readIoFile(lp, dirFd, scanner->now);
+      proc->changed |= PROCESS_FLAG_IO;
+   }
    #endif
 
-   dir = opendir(dirname);
-   if (!dir) return false;
-   int cpus = pl->cpuCount;
-   bool hideKernelThreads = settings->hideKernelThreads;
-   bool hideUserlandThreads = settings->hideUserlandThreads;
-   while ((entry = readdir(dir)) != NULL) {
-      char* name = entry->d_name;
+   if (proc->state == 'Z' && (proc->basenameOffset == 0)) {
+      proc->basenameOffset = -1;
+      setCommand(proc, command, commLen);
+   } else if (Process_isThread(proc)) {
+      if (settings->showThreadNames || Process_isKernelThread(proc) || (proc->state == 'Z' && proc->basenameOffset == 0)) {
+         proc->basenameOffset = -1;
+         setCommand(proc, command, commLen);
+      } else if (settings->showThreadNames) {
+         if (! LinuxProcessList_readCmdlineFile(proc, dirFd))
+            goto errorReadingProcess;
+      }
+      if (Process_isKernelThread(proc)) {
+         scanner->kernelThreads++;
+      } else {
+         scanner->userlandThreads++;
+      }
+   }
 
-      // The RedHat kernel hides threads with a dot.
-      // I believe this is non-standard.
-      if ((!settings->hideThreads) && name[0] == '.') {
-         name++;
+   // Single-threaded processes have no other tasks to list, and hidden
+   // threads are only counted, from the thread count in stat.
+   if (!parent && proc->nlwp > 1) {
+      if (settings->hideUserlandThreads) {
+         scanner->totalTasks += proc->nlwp - 1;
+         scanner->userlandThreads += proc->nlwp - 1;
+      } else {
+         int taskFd = openat(dirFd, "task", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+         if (taskFd != -1)
+            LinuxProcessList_recurseProcTree(scanner, taskFd, proc);
       }
+   }
 
-      // Just skip all non-number directories.
-      if (name[0] < '0' || name[0] > '9') {
-         continue;
+   // new processes get added to the list, and owners get looked up, later
+   if (!preExisting || reused)
+      LinuxProcessScanner_add(scanner, proc);
+
+   scanner->totalTasks++;
+   if (proc->state == 'R')
+      scanner->runningTasks++;
+   proc->updated = true;
+   if (dirFd != lp->procDirFd)
+      close(dirFd);
+   return;
+
+   // Exception handler.
+   errorReadingProcess: {
+      if (dirFd != -1 && dirFd != lp->procDirFd)
+         close(dirFd);
+      if (preExisting) {
+         // left not updated, so ProcessList_scan drops it
+         proc->updated = false;
+      } else {
+         Process_delete((Object*)proc);
       }
+   }
+}
 
-      // filename is a number: process directory
-      int pid = atoi(name);
-     
-      if (parent && pid == parent->pid)
-         continue;
+static inline bool LinuxProcessList_isProcessDir(Settings* settings, char** name) {
+   // The RedHat kernel hides threads with a dot.
+   // I believe this is non-standard.
+   if ((!settings->hideThreads) && (*name)[0] == '.') {
+      (*name)++;
+   }
 
-      if (pid <= 0) 
-         continue;
+   // Just skip all non-number directories.
+   return ((*name)[0] >= '0' && (*name)[0] <= '9');
+}
 
-      bool preExisting = false;
-      Process* proc = ProcessList_getProcess(pl, pid, &preExisting, (Process_New) LinuxProcess_new);
-      proc->tgid = parent ? parent->pid : pid;
-      
-      LinuxProcess* lp = (LinuxProcess*) proc;
+static bool LinuxProcessList_recurseProcTree(LinuxProcessScanner* scanner, int dirFd, Process* parent) {
+   Settings* settings = scanner->pl->super.settings;
+   DIR* dir;
+   struct dirent* entry;
 
-      char subdirname[MAX_NAME+1];
-      xSnprintf(subdirname, MAX_NAME, "%s/%s/task", dirname, name);
-      LinuxProcessList_recurseProcTree(this, subdirname, proc, period, tv);
+   dir = fdopendir(dirFd);
+   if (!dir) {
+      close(dirFd);
+      return false;
+   }
+   while ((entry = readdir(dir)) != NULL) {
+      char* name = entry->d_name;
 
-      #ifdef HAVE_TASKSTATS
-      if (settings->flags & PROCESS_FLAG_IO)
-         LinuxProcessList_readIoFile(lp, dirname, name, now);
-      #endif
+      if (!LinuxProcessList_isProcessDir(settings, &name))
+         continue;
 
-      if (! LinuxProcessList_readStatmFile(lp, dirname, name))
-         goto errorReadingProcess;
+      // filename is a number: process directory
+      int pid = atoi(name);
 
-      proc->show = ! ((hideKernelThreads && Process_isKernelThread(proc)) || (hideUserlandThreads && Process_isUserlandThread(proc)));
+      if (parent && pid == parent->pid)
+         continue;
 
-      char command[MAX_NAME+1];
-      unsigned long long int lasttimes = (lp->utime + lp->stime);
-      int commLen = 0;
-      unsigned int tty_nr = proc->tty_nr;
-      if (! LinuxProcessList_readStatFile(proc, dirname, name, command, &commLen))
-         goto errorReadingProcess;
-      if (tty_nr != proc->tty_nr && this->ttyDrivers) {
-         free(lp->ttyDevice);
-         lp->ttyDevice = LinuxProcessList_updateTtyDevice(this->ttyDrivers, proc->tty_nr);
-      }
-      if (settings->flags & PROCESS_FLAG_LINUX_IOPRIO)
-         LinuxProcess_updateIOPriority(lp);
-      float percent_cpu = (lp->utime + lp->stime - lasttimes) / period * 100.0;
-      proc->percent_cpu = CLAMP(percent_cpu, 0.0, cpus * 100.0);
-      if (isnan(proc->percent_cpu)) proc->percent_cpu = 0.0;
-      proc->percent_mem = (proc->m_resident * PAGE_SIZE_KB) / (double)(pl->totalMem) * 100.0;
+      if (pid <= 0)
+         continue;
 
-      if(!preExisting) {
+      LinuxProcessList_readProcess(scanner, dirFd, name, parent);
+   }
+   closedir(dir);
+   return true;
+}
 
-         if (! LinuxProcessList_statProcessDir(proc, dirname, name))
-            goto errorReadingProcess;
+#ifdef HAVE_LIBPTHREAD
 
-         proc->user = UsersTable_getRef(pl->usersTable, proc->st_uid);
+typedef struct LinuxProcessScanQueue_ {
+   int procFd;
+   int* pids;
+   int count;
+   int next;
+} LinuxProcessScanQueue;
 
-         #ifdef HAVE_OPENVZ
-         if (settings->flags & PROCESS_FLAG_LINUX_OPENVZ) {
-            LinuxProcessList_readOpenVZData(lp, dirname, name);
-         }
-         #endif
-         
-         #ifdef HAVE_VSERVER
-         if (settings->flags & PROCESS_FLAG_LINUX_VSERVER) {
-            LinuxProcessList_readVServerData(lp, dirname, name);
-         }
-         #endif
+typedef struct LinuxProcessScanWorker_ {
+   LinuxProcessScanner scanner;
+   LinuxProcessScanQueue* queue;
+   pthread_t thread;
+} LinuxProcessScanWorker;
 
-         if (! LinuxProcessList_readCmdlineFile(proc, dirname, name)) {
-            goto errorReadingProcess;
-         }
+static void* LinuxProcessScanWorker_run(void* data) {
+   LinuxProcessScanWorker* worker = (LinuxProcessScanWorker*) data;
+   LinuxProcessScanQueue* queue = worker->queue;
+   for (;;) {
+      int i = __sync_fetch_and_add(&queue->next, 1);
+      if (i >= queue->count)
+         break;
+      char name[16];
+      xSnprintf(name, sizeof(name), "%d", queue->pids[i]);
+      LinuxProcessList_readProcess(&worker->scanner, queue->procFd, name, NULL);
+   }
+   return NULL;
+}
 
-         ProcessList_add(pl, proc);
-      } else {
-         if (settings->updateProcessNames && proc->state != 'Z') {
-            if (! LinuxProcessList_readCmdlineFile(proc, dirname, name)) {
-               goto errorReadingProcess;
-            }
-         }
+static void LinuxProcessList_listProcesses(Settings* settings, DIR* dir, LinuxProcessScanQueue* queue) {
+   int size = 0;
+   struct dirent* entry;
+   while ((entry = readdir(dir)) != NULL) {
+      char* name = entry->d_name;
+      if (!LinuxProcessList_isProcessDir(settings, &name))
+         continue;
+      int pid = atoi(name);
+      if (pid <= 0)
+         continue;
+      if (queue->count == size) {
+         size = size ? size * 2 : 512;
+         queue->pids = xRealloc(queue->pids, sizeof(int) * size);
       }
+      queue->pids[queue->count++] = pid;
+   }
+}
 
-      #ifdef HAVE_DELAYACCT
-      LinuxProcessList_readDelayAcctData(this, lp);
-      #endif
+#endif
 
-      #ifdef HAVE_CGROUP
-      if (settings->flags & PROCESS_FLAG_LINUX_CGROUP)
-         LinuxProcessList_readCGroupFile(lp, dirname, name);
-      #endif
-      
-      if (settings->flags & PROCESS_FLAG_LINUX_OOM)
-         LinuxProcessList_readOomData(lp, dirname, name);
+static void LinuxProcessList_mergeScanner(LinuxProcessList* this, LinuxProcessScanner* scanner) {
+   ProcessList* pl = (ProcessList*) this;
+   for (int i = 0; i < scanner->addedCount; i++) {
+      Process* proc = scanner->added[i];
+      proc->user = UsersTable_getRef(pl->usersTable, proc->st_uid);
+      // reused PIDs are already in the list
+      if (Hashtable_get(pl->processTable, proc->pid) != proc)
+         ProcessList_add(pl, proc);
+   }
+   free(scanner->added);
+   pl->totalTasks += scanner->totalTasks;
+   pl->runningTasks += scanner->runningTasks;
+   pl->userlandThreads += scanner->userlandThreads;
+   pl->kernelThreads += scanner->kernelThreads;
+   this->scanTick.keptFdHits += scanner->keptFdHits;
+   this->scanTick.keptFdMisses += scanner->keptFdMisses;
+   this->scanTick.cmdlineReads += scanner->cmdlineReads;
+   this->scanTick.cmdlineSkips += scanner->cmdlineSkips;
+}
 
-      if (proc->state == 'Z' && (proc->basenameOffset == 0)) {
-         proc->basenameOffset = -1;
-         setCommand(proc, command, commLen);
-      } else if (Process_isThread(proc)) {
-         if (settings->showThreadNames || Process_isKernelThread(proc) || (proc->state == 'Z' && proc->basenameOffset == 0)) {
-            proc->basenameOffset = -1;
-            setCommand(proc, command, commLen);
-         } else if (settings->showThreadNames) {
-            if (! LinuxProcessList_readCmdlineFile(proc, dirname, name))
-               goto errorReadingProcess;
-         }
-         if (Process_isKernelThread(proc)) {
-            pl->kernelThreads++;
-         } else {
-            pl->userlandThreads++;
-         }
+static void LinuxProcessList_scanProcesses(LinuxProcessList* this, double period, struct timeval tv) {
+   int threads = this->super.settings->scanThreads;
+   LinuxProcessScanner init = {
+      .pl = this,
+      .period = period,
+      .now = tv.tv_sec*1000LL+tv.tv_usec/1000LL,
+      .scanCount = this->scanCount,
+   };
+   this->scanTick = (LinuxScanCounters) { 0 };
+
+   #ifdef HAVE_LIBPTHREAD
+   if (threads > 1) {
+      // Workers only read /proc and fill in their own processes; the
+      // process list and users table are updated here once they are done.
+      DIR* dir = opendir(PROCDIR);
+      if (!dir)
+         return;
+      LinuxProcessScanQueue queue = { .procFd = dirfd(dir), .pids = NULL, .count = 0, .next = 0 };
+      LinuxProcessList_listProcesses(this->super.settings, dir, &queue);
+      LinuxProcessScanWorker* workers = xCalloc(threads, sizeof(LinuxProcessScanWorker));
+      int started = 0;
+      for (int i = 0; i < threads; i++) {
+         workers[i].scanner = init;
+         workers[i].queue = &queue;
+         if (i > 0 && pthread_create(&workers[i].thread, NULL, LinuxProcessScanWorker_run, &workers[i]) != 0)
+            break;
+         started++;
       }
+      // the main thread works as well
+      LinuxProcessScanWorker_run(&workers[0]);
+      for (int i = 1; i < started; i++)
+         pthread_join(workers[i].thread, NULL);
+      for (int i = 0; i < started; i++)
+         LinuxProcessList_mergeScanner(this, &workers[i].scanner);
+      free(workers);
+      free(queue.pids);
+      closedir(dir);
+      return;
+   }
+   #else
+   (void) threads;
+   #endif
 
-      pl->totalTasks++;
-      if (proc->state == 'R')
-         pl->runningTasks++;
-      proc->updated = true;
-      continue;
+   int procFd = open(PROCDIR, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+   if (procFd == -1)
+      return;
+   LinuxProcessScanner* scanner = xMalloc(sizeof(LinuxProcessScanner));
+   *scanner = init;
+   LinuxProcessList_recurseProcTree(scanner, procFd, NULL);
+   LinuxProcessList_mergeScanner(this, scanner);
+   free(scanner);
+}
 
-      // Exception handler.
-      errorReadingProcess: {
-         if (preExisting) {
-            ProcessList_remove(pl, proc);
-         } else {
-            Process_delete((Object*)proc);
+#ifdef HAVE_DELAYACCT
+
+static void LinuxProcessList_scanDelayAcctData(LinuxProcessList* this) {
+   // The netlink socket is shared, so this is done serially after the scan.
+   // Within the time budget, processes are taken in rounds: each is read
+   // once per round, so the list being sorted between scans does not
+   // matter, and the rest keep their values, as stale. Out of view, only
+   // processes never read are, unless sorted by it.
+   Settings* settings = this->super.settings;
+   if (!(settings->flags & PROCESS_FLAG_LINUX_DELAYACCT))
+      return;
+   bool all = Process_fields[settings->sortKey].flags & PROCESS_FLAG_LINUX_DELAYACCT;
+   Vector* processes = this->super.processes;
+   int size = Vector_size(processes);
+   if (size == 0)
+      return;
+   struct timespec start, now;
+   clock_gettime(CLOCK_MONOTONIC, &start);
+   long long budget = settings->delayAcctBudget * 1000000LL;
+   for (int i = 0; i < size; i++) {
+      LinuxProcess* lp = (LinuxProcess*) Vector_get(processes, i);
+      if (lp->delay && lp->delay->round == this->delayAcctRound)
+         continue;
+      if (lp->super.updated && (all || lp->super.inView || !(lp->collectedFlags & PROCESS_FLAG_LINUX_DELAYACCT))) {
+         if (budget) {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            if ((now.tv_sec - start.tv_sec) * 1000000000LL + (now.tv_nsec - start.tv_nsec) > budget)
+               return;
          }
+         LinuxProcessList_readDelayAcctData(this, lp);
+         lp->delay->round = this->delayAcctRound;
+         lp->collectedFlags |= PROCESS_FLAG_LINUX_DELAYACCT;
+         lp->staleFlags &= ~PROCESS_FLAG_LINUX_DELAYACCT;
       }
    }
-   closedir(dir);
-   return true;
+   // all were read within the budget: the next scan starts a new round
+   this->delayAcctRound++;
 }
 
+#endif
+
 static inline void LinuxProcessList_scanMemoryInfo(ProcessList* this) {
    unsigned long long int swapFree = 0;
    unsigned long long int shmem = 0;
@@ -1030,10 +1549,64 @@ static inline double LinuxProcessList_scanCPUTime(LinuxProcessList* this) {
       cpuData->totalTime = totaltime;
    }
    double period = (double)this->cpus[0].totalPeriod / cpus;
+   char buffer[PROC_LINE_LENGTH + 1];
+   while (fgets(buffer, PROC_LINE_LENGTH, file)) {
+      if (String_startsWith(buffer, "procs_running ")) {
+         this->procsRunning = atoi(buffer + strlen("procs_running "));
+         break;
+      }
+   }
    fclose(file);
    return period;
 }
 
+static void LinuxProcessList_scanOutput(LinuxProcessList* this, struct timeval tv) {
+   // htop writes to nothing but the terminal while running
+   FILE* file = fopen(PROCDIR "/self/io", "r");
+   if (!file)
+      return;
+   unsigned long long wchar = this->outputBytes;
+   char buffer[256];
+   while (fgets(buffer, sizeof(buffer), file)) {
+      if (String_startsWith(buffer, "wchar:")) {
+         sscanf(buffer + 6, "%32llu", &wchar);
+         break;
+      }
+   }
+   fclose(file);
+   double now = tv.tv_sec + tv.tv_usec / 1000000.0;
+   if (this->outputTime > 0 && now > this->outputTime)
+      this->outputRate = (wchar - this->outputBytes) / (now - this->outputTime);
+   this->outputBytes = wchar;
+   this->outputTime = now;
+}
+
+static void LinuxProcessList_countAllocations(LinuxProcessList* this) {
+   LinuxAllocCounters total = {
+      .processes = LinuxProcess_slab->allocs,
+      .processChunks = LinuxProcess_slab->chunkAllocs,
+      .processFrees = LinuxProcess_slab->frees,
+      .strings = LinuxProcess_strings->misses,
+      .stringsShared = LinuxProcess_strings->hits,
+      .stringsReclaimed = LinuxProcess_strings->reclaimed,
+   };
+   #ifdef HAVE_CGROUP
+   total.strings += LinuxProcess_cgroups->misses;
+   total.stringsShared += LinuxProcess_cgroups->hits;
+   total.stringsReclaimed += LinuxProcess_cgroups->reclaimed;
+   #endif
+   LinuxAllocCounters* last = &this->allocTotal;
+   this->allocTick = (LinuxAllocCounters) {
+      .processes = total.processes - last->processes,
+      .processChunks = total.processChunks - last->processChunks,
+      .processFrees = total.processFrees - last->processFrees,
+      .strings = total.strings - last->strings,
+      .stringsShared = total.stringsShared - last->stringsShared,
+      .stringsReclaimed = total.stringsReclaimed - last->stringsReclaimed,
+   };
+   *last = total;
+}
+
 void ProcessList_goThroughEntries(ProcessList* super) {
    LinuxProcessList* this = (LinuxProcessList*) super;
 
@@ -1042,5 +1615,22 @@ void ProcessList_goThroughEntries(ProcessList* super) {
 
    struct timeval tv;
    gettimeofday(&tv, NULL);
-   LinuxProcessList_recurseProcTree(this, PROCDIR, NULL, period, tv);
+   this->scanCount++;
+   LinuxProcessList_scanProcesses(this, period, tv);
+
+   // running threads were not seen when not listed: take the kernel's count
+   if (super->settings->hideUserlandThreads || super->settings->hideKernelThreads)
+      super->runningTasks = this->procsRunning;
+
+   #ifdef HAVE_DELAYACCT
+   LinuxProcessList_scanDelayAcctData(this);
+   #endif
+
+   StringPool_sweep(LinuxProcess_strings);
+   #ifdef HAVE_CGROUP
+   StringPool_sweep(LinuxProcess_cgroups);
+   StringPool_updateRanks(LinuxProcess_cgroups);
+   #endif
+   LinuxProcessList_countAllocations(this);
+   LinuxProcessList_scanOutput(this, tv);
 }
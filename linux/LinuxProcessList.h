@@ -9,6 +9,8 @@ Released under the GNU GPL, see the COPYING file
 in the source distribution for its full text.
 */
 
+#ifdef HAVE_LIBPTHREAD
+#endif
 #ifdef MAJOR_IN_MKDEV
 #elif defined(MAJOR_IN_SYSMACROS) || \
    (defined(HAVE_SYS_SYSMACROS_H) && HAVE_SYS_SYSMACROS_H)
@@ -57,6 +59,23 @@ typedef struct TtyDriver_ {
    unsigned int minorTo;
 } TtyDriver;
 
+typedef struct LinuxAllocCounters_ {
+   unsigned long long processes;
+   unsigned long long processChunks;
+   unsigned long long processFrees;
+   unsigned long long strings;
+   unsigned long long stringsShared;
+   unsigned long long stringsReclaimed;
+} LinuxAllocCounters;
+
+typedef struct LinuxScanCounters_ {
+   unsigned long long keptFdHits;
+   unsigned long long keptFdMisses;
+   // cmdline files read for updateProcessNames, and reads skipped
+   unsigned long long cmdlineReads;
+   unsigned long long cmdlineSkips;
+} LinuxScanCounters;
+
 typedef struct LinuxProcessList_ {
    ProcessList super;
    
@@ -67,6 +86,27 @@ typedef struct LinuxProcessList_ {
    struct nl_sock *netlink_socket;
    int netlink_family;
    #endif
+
+   int procsRunning;
+
+   int keptFdLimit;
+
+   unsigned int scanCount;
+   #ifdef HAVE_DELAYACCT
+   unsigned int delayAcctRound;
+   #endif
+
+   // bytes written by htop, ever and per second over the last scan
+   unsigned long long outputBytes;
+   double outputRate;
+   double outputTime;
+
+   // process and string allocator counters, ever and since the last scan
+   LinuxAllocCounters allocTotal;
+   LinuxAllocCounters allocTick;
+
+   // file reads of the last scan
+   LinuxScanCounters scanTick;
 } LinuxProcessList;
 
 #ifndef PROCDIR
@@ -89,11 +129,80 @@ typedef struct LinuxProcessList_ {
 #define PROC_LINE_LENGTH 4096
 #endif
 
+// fields of /proc/<pid>/stat, numbered from 1 as in proc(5)
+typedef enum LinuxStatField_ {
+   STAT_PPID = 4,
+   STAT_PGRP = 5,
+   STAT_SESSION = 6,
+   STAT_TTY_NR = 7,
+   STAT_TPGID = 8,
+   STAT_FLAGS = 9,
+   STAT_MINFLT = 10,
+   STAT_CMINFLT = 11,
+   STAT_MAJFLT = 12,
+   STAT_CMAJFLT = 13,
+   STAT_UTIME = 14,
+   STAT_STIME = 15,
+   STAT_CUTIME = 16,
+   STAT_CSTIME = 17,
+   STAT_PRIORITY = 18,
+   STAT_NICE = 19,
+   STAT_NLWP = 20,
+   STAT_STARTTIME = 22,
+   STAT_STARTCODE = 26,
+   STAT_ENDCODE = 27,
+   STAT_EXIT_SIGNAL = 38,
+   STAT_PROCESSOR = 39,
+   // OpenVZ kernels append these
+   STAT_VPID = 52,
+   STAT_CTID = 53,
+} LinuxStatField;
+
+// index in the fields split from the state on
+#define STAT_FIELD(name_) (STAT_ ## name_ - STAT_PPID)
+
+#ifndef PROC_STAT_FIELDS
+#define PROC_STAT_FIELDS (STAT_FIELD(CTID) + 1)
+#endif
+
+#ifndef MAX_KEPT_FDS
+// descriptors opened later, such as the strace pipe, go to select()
+#define MAX_KEPT_FDS (FD_SETSIZE - 128)
+#endif
+
+// with updateProcessNames, scans between re-reads of a cmdline that shows
+// no sign of an exec, to catch processes that rewrite their argv
+#ifndef CMDLINE_REVERIFY_PERIOD
+#define CMDLINE_REVERIFY_PERIOD 8
+#endif
+
+// with hideKernelThreads, scans between reads of a kernel thread's stat,
+// to notice its PID being taken by another process
+#ifndef KERNEL_THREAD_REVERIFY_PERIOD
+#define KERNEL_THREAD_REVERIFY_PERIOD 8
+#endif
+
+// with lowBandwidth, smallest change of CPU% shown, in percentage points
+#ifndef LOW_BANDWIDTH_CPU_STEP
+#define LOW_BANDWIDTH_CPU_STEP 0.5
+#endif
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
+#ifdef O_PATH
+#define PROC_DIR_FLAGS (O_PATH | O_DIRECTORY | O_CLOEXEC)
+#else
+#define PROC_DIR_FLAGS (O_RDONLY | O_DIRECTORY | O_CLOEXEC)
+#endif
+
 
 #ifndef CLAMP
 #define CLAMP(x,low,high) (((x)>(high))?(high):(((x)<(low))?(low):(x)))
 #endif
 
+
 #ifdef HAVE_DELAYACCT
 
 #endif
@@ -117,6 +226,21 @@ void ProcessList_delete(ProcessList* pl);
 
 #ifdef HAVE_VSERVER
 
+#endif
+
+#ifdef HAVE_DELAYACCT
+
+#endif
+
+/*
+ * An exec changes the comm and code segment shown in stat; a process
+ * rewriting its argv changes neither, and is caught by the periodic re-read.
+ */
+
+#ifdef HAVE_LIBPTHREAD
+
+
+
 #endif
 
 #ifdef HAVE_DELAYACCT
@@ -0,0 +1,66 @@
+/*
+htop - linux/OutputMeter.c
+(C) 2004-2011 Hisham H. Muhammad
+Released under the GNU GPL, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "OutputMeter.h"
+
+#include "LinuxProcessList.h"
+#include "CRT.h"
+
+/*{
+#include "Meter.h"
+}*/
+
+int OutputMeter_attributes[] = {
+   METER_VALUE
+};
+
+static void OutputMeter_bytes(char* buffer, int len, double bytes) {
+   if (bytes < 1024)
+      xSnprintf(buffer, len, "%dB", (int) bytes);
+   else
+      Meter_humanUnit(buffer, bytes / 1024, len);
+}
+
+static void OutputMeter_updateValues(Meter* this, char* buffer, int len) {
+   LinuxProcessList* lpl = (LinuxProcessList*) this->pl;
+   this->values[0] = lpl->outputRate;
+   if (this->values[0] > this->total) {
+      this->total = this->values[0];
+   }
+   char rate[32];
+   OutputMeter_bytes(rate, sizeof(rate), lpl->outputRate);
+   xSnprintf(buffer, len, "%s/s", rate);
+}
+
+static void OutputMeter_display(Object* cast, RichString* out) {
+   Meter* this = (Meter*)cast;
+   LinuxProcessList* lpl = (LinuxProcessList*) this->pl;
+   char buffer[32];
+
+   OutputMeter_bytes(buffer, sizeof(buffer), lpl->outputRate);
+   RichString_write(out, CRT_colors[METER_VALUE], buffer);
+   RichString_append(out, CRT_colors[METER_TEXT], "/s written, ");
+   OutputMeter_bytes(buffer, sizeof(buffer), lpl->outputBytes);
+   RichString_append(out, CRT_colors[METER_VALUE], buffer);
+   RichString_append(out, CRT_colors[METER_TEXT], " in total");
+}
+
+MeterClass OutputMeter_class = {
+   .super = {
+      .extends = Class(Meter),
+      .delete = Meter_delete,
+      .display = OutputMeter_display,
+   },
+   .updateValues = OutputMeter_updateValues,
+   .defaultMode = TEXT_METERMODE,
+   .maxItems = 1,
+   .total = 1.0,
+   .attributes = OutputMeter_attributes,
+   .name = "Output",
+   .uiName = "Terminal output (debug)",
+   .caption = "Output: "
+};
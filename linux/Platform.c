@@ -21,6 +21,9 @@ in the source distribution for its full text.
 #include "UptimeMeter.h"
 #include "ClockMeter.h"
 #include "HostnameMeter.h"
+#include "AllocationsMeter.h"
+#include "OutputMeter.h"
+#include "ScanMeter.h"
 #include "LinuxProcess.h"
 
 #include <math.h>
@@ -126,6 +129,9 @@ MeterClass* Platform_meterTypes[] = {
    &LeftCPUs2Meter_class,
    &RightCPUs2Meter_class,
    &BlankMeter_class,
+   &AllocationsMeter_class,
+   &OutputMeter_class,
+   &ScanMeter_class,
    NULL
 };
 
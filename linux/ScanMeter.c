@@ -0,0 +1,62 @@
+/*
+htop - linux/ScanMeter.c
+(C) 2004-2011 Hisham H. Muhammad
+Released under the GNU GPL, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "ScanMeter.h"
+
+#include "LinuxProcessList.h"
+#include "CRT.h"
+
+/*{
+#include "Meter.h"
+}*/
+
+int ScanMeter_attributes[] = {
+   PROCESS, PROCESS_THREAD
+};
+
+static void ScanMeter_updateValues(Meter* this, char* buffer, int len) {
+   LinuxProcessList* lpl = (LinuxProcessList*) this->pl;
+   this->values[0] = lpl->scanTick.keptFdHits;
+   this->values[1] = lpl->scanTick.keptFdMisses;
+   double sum = this->values[0] + this->values[1];
+   if (sum > this->total) {
+      this->total = sum;
+   }
+   xSnprintf(buffer, len, "%d/%d", (int) this->values[0], (int) this->values[1]);
+}
+
+static void ScanMeter_display(Object* cast, RichString* out) {
+   Meter* this = (Meter*)cast;
+   LinuxScanCounters* tick = &((LinuxProcessList*) this->pl)->scanTick;
+   char buffer[64];
+
+   xSnprintf(buffer, sizeof(buffer), "%llu", tick->keptFdHits);
+   RichString_write(out, CRT_colors[METER_VALUE], buffer);
+   xSnprintf(buffer, sizeof(buffer), " kept/%llu opened files", tick->keptFdMisses);
+   RichString_append(out, CRT_colors[METER_TEXT], buffer);
+   RichString_append(out, CRT_colors[METER_TEXT], ", ");
+   xSnprintf(buffer, sizeof(buffer), "%llu", tick->cmdlineReads);
+   RichString_append(out, CRT_colors[METER_VALUE], buffer);
+   xSnprintf(buffer, sizeof(buffer), " read/%llu skipped cmdlines", tick->cmdlineSkips);
+   RichString_append(out, CRT_colors[METER_TEXT], buffer);
+}
+
+MeterClass ScanMeter_class = {
+   .super = {
+      .extends = Class(Meter),
+      .delete = Meter_delete,
+      .display = ScanMeter_display,
+   },
+   .updateValues = ScanMeter_updateValues,
+   .defaultMode = TEXT_METERMODE,
+   .maxItems = 2,
+   .total = 1.0,
+   .attributes = ScanMeter_attributes,
+   .name = "Scan",
+   .uiName = "Scan (debug)",
+   .caption = "Scan: "
+};
@@ -0,0 +1,18 @@
+/* Do not edit this file. It was automatically generated. */
+
+#ifndef HEADER_ScanMeter
+#define HEADER_ScanMeter
+/*
+htop - linux/ScanMeter.h
+(C) 2004-2011 Hisham H. Muhammad
+Released under the GNU GPL, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "Meter.h"
+
+extern int ScanMeter_attributes[];
+
+extern MeterClass ScanMeter_class;
+
+#endif